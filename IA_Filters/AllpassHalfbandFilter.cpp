@@ -0,0 +1,239 @@
+#include "AllpassHalfbandFilter.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace IADSP
+{
+    // Elliptic halfband design for the polyphase allpass structure - the classic recipe (as used by
+    // e.g. Laurent de Soras' HIIR): the transition bandwidth sets the selectivity factor k and nome q,
+    // the attenuation then sets the (odd) filter order, and each allpass coefficient is found from a
+    // pair of rapidly converging theta-function series.
+    namespace
+    {
+        double integerPower(double x, int n)
+        {
+            double result = 1.0;
+            for(int i = 0; i < n; ++i) {
+                result *= x;
+            }
+            return result;
+        }
+
+        double thetaNumerator(double q, int order, int c)
+        {
+            double acc = 0.0, term = 0.0;
+            int i = 0, sign = 1;
+            do
+            {
+                term = integerPower(q, i * (i + 1)) * std::sin((i * 2 + 1) * c * std::numbers::pi / order) * sign;
+                acc += term;
+                sign = -sign;
+                ++i;
+            } while(std::abs(term) > 1.0e-100);
+            return acc;
+        }
+
+        double thetaDenominator(double q, int order, int c)
+        {
+            double acc = 0.0, term = 0.0;
+            int i = 1, sign = -1;
+            do
+            {
+                term = integerPower(q, i * i) * std::cos(i * 2 * c * std::numbers::pi / order) * sign;
+                acc += term;
+                sign = -sign;
+                ++i;
+            } while(std::abs(term) > 1.0e-100);
+            return acc;
+        }
+    }
+
+    template<typename Type>
+    AllpassHalfbandFilter<Type>::AllpassHalfbandFilter(double stopbandAttenuationDB, double transitionBandwidth)
+    {
+        setDesign(stopbandAttenuationDB, transitionBandwidth);
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::setDesign(double stopbandAttenuationDB, double transitionBandwidth)
+    {
+        assert(stopbandAttenuationDB > 0.0);
+        assert(transitionBandwidth > 0.0 && transitionBandwidth < 0.5);
+
+        transitionBandwidth = std::clamp(transitionBandwidth, 1.0e-4, 0.5 - 1.0e-4);
+
+        auto k = std::tan((1.0 - transitionBandwidth * 2.0) * std::numbers::pi / 4.0);
+        k *= k;
+        const auto kRoot = std::pow(1.0 - k * k, 0.25);
+        const auto e = 0.5 * (1.0 - kRoot) / (1.0 + kRoot);
+        const auto e4 = e * e * e * e;
+        const auto q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+        const auto attenuationPower = std::pow(10.0, -stopbandAttenuationDB / 10.0);
+        const auto a = attenuationPower / (1.0 - attenuationPower);
+        auto order = static_cast<int>(std::ceil(std::log(a * a / 16.0) / std::log(q)));
+        if(order % 2 == 0) {
+            ++order;
+        }
+        order = std::max(order, 3);
+
+        const auto numCoefficients = (order - 1) / 2;
+        coefficients.resize(numCoefficients);
+
+        for(int i = 0; i < numCoefficients; ++i)
+        {
+            const auto c = i + 1;
+            const auto num = thetaNumerator(q, order, c) * std::pow(q, 0.25);
+            const auto den = thetaDenominator(q, order, c) + 0.5;
+            const auto ww = num / den;
+            const auto wwSquared = ww * ww;
+            const auto x = std::sqrt((1.0 - wwSquared * k) * (1.0 - wwSquared / k)) / (1.0 + wwSquared);
+            coefficients[i] = static_cast<Type>((1.0 - x) / (1.0 + x));
+        }
+
+        setNumChannels(numChannels);
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::setNumChannels(int newNumChannels)
+    {
+        numChannels = newNumChannels;
+        states.resize(numChannels);
+        for(auto& state : states)
+        {
+            state.x.resize(coefficients.size());
+            state.y.resize(coefficients.size());
+        }
+
+        reset();
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::reset() noexcept
+    {
+        const auto zero = static_cast<Type>(0.0);
+        for(auto& state : states)
+        {
+            std::fill(state.x.begin(), state.x.end(), zero);
+            std::fill(state.y.begin(), state.y.end(), zero);
+        }
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::snapToZero() noexcept
+    {
+        const auto zero = static_cast<Type>(0.0);
+        const auto min  = static_cast<Type>(1.0e-8);
+
+        for(auto& state : states)
+        {
+            for(auto& v : state.x) {
+                if (! (v < -min || v > min)) {
+                    v = zero;
+                }
+            }
+
+            for(auto& v : state.y) {
+                if (! (v < -min || v > min)) {
+                    v = zero;
+                }
+            }
+        }
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::interpolate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
+    {
+        const auto* coefs = coefficients.data();
+        const auto numCoefs = coefficients.size();
+        auto* x = states[channel].x.data();
+        auto* y = states[channel].y.data();
+
+        for(size_t i = 0; i < input.size(); ++i)
+        {
+            auto even = input[i];
+            auto odd = input[i];
+
+            // first-order allpass in z^2: y[n] = c * (x[n] - y[n-1]) + x[n-1], one section per branch per step
+            size_t k = 0;
+            for(; k + 1 < numCoefs; k += 2)
+            {
+                const auto evenOut = (even - y[k]) * coefs[k] + x[k];
+                const auto oddOut = (odd - y[k + 1]) * coefs[k + 1] + x[k + 1];
+                x[k] = even;
+                x[k + 1] = odd;
+                y[k] = evenOut;
+                y[k + 1] = oddOut;
+                even = evenOut;
+                odd = oddOut;
+            }
+            if(k < numCoefs)
+            {
+                const auto evenOut = (even - y[k]) * coefs[k] + x[k];
+                x[k] = even;
+                y[k] = evenOut;
+                even = evenOut;
+            }
+
+            output[2 * i] = even;
+            output[2 * i + 1] = odd;
+        }
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::interpolate(const Type* input, Type* output, size_t numInputSamples, int channel) noexcept
+    {
+        interpolate(std::span<const Type>(input, numInputSamples), std::span<Type>(output, 2 * numInputSamples), channel);
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::decimate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
+    {
+        const auto* coefs = coefficients.data();
+        const auto numCoefs = coefficients.size();
+        auto* x = states[channel].x.data();
+        auto* y = states[channel].y.data();
+        const auto half = static_cast<Type>(0.5);
+
+        for(size_t i = 0; i < output.size(); ++i)
+        {
+            // A0 sees the odd-phase (later) sample of the pair, z^-1 * A1 the even-phase one
+            auto even = input[2 * i + 1];
+            auto odd = input[2 * i];
+
+            size_t k = 0;
+            for(; k + 1 < numCoefs; k += 2)
+            {
+                const auto evenOut = (even - y[k]) * coefs[k] + x[k];
+                const auto oddOut = (odd - y[k + 1]) * coefs[k + 1] + x[k + 1];
+                x[k] = even;
+                x[k + 1] = odd;
+                y[k] = evenOut;
+                y[k + 1] = oddOut;
+                even = evenOut;
+                odd = oddOut;
+            }
+            if(k < numCoefs)
+            {
+                const auto evenOut = (even - y[k]) * coefs[k] + x[k];
+                x[k] = even;
+                y[k] = evenOut;
+                even = evenOut;
+            }
+
+            output[i] = half * (even + odd);
+        }
+    }
+
+    template<typename Type>
+    void AllpassHalfbandFilter<Type>::decimate(const Type* input, Type* output, size_t numOutputSamples, int channel) noexcept
+    {
+        decimate(std::span<const Type>(input, 2 * numOutputSamples), std::span<Type>(output, numOutputSamples), channel);
+    }
+
+    //==============================================================================
+    template class AllpassHalfbandFilter<float>;
+    template class AllpassHalfbandFilter<double>;
+}
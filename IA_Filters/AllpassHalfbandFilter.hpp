@@ -0,0 +1,63 @@
+/*
+This is a polyphase IIR halfband filter built from two parallel branches of first-order allpass sections
+(the Regalia-Mitra / "polyphase allpass" structure, with coefficients designed the elliptic way described
+by Valenzuela & Constantinides). It is used to interpolate a signal up by 2x (with anti-imaging
+filtering) or decimate it back down by 2x (with anti-aliasing filtering). IMPORTANT: do not use it to do
+both - like ButterworthHalfbandFilter, each instance keeps a single set of per-channel state.
+
+The halfband response is H(z) = 0.5 * (A0(z^2) + z^-1 * A1(z^2)), where A0 and A1 are each a cascade of
+allpass sections in z^2. Because the branches only ever see every other high-rate sample, both run at the
+LOW rate: interpolation feeds each input sample through both branches and emits their outputs as the two
+high-rate samples (no zero-stuffing, so no multiplies by zero), and decimation feeds each input pair one
+sample per branch and averages. Each section is a single multiply, so an interpolate() or decimate() call
+costs getNumCoefficients() multiplies per low-rate sample - a fraction of what a Butterworth cascade of
+similar attenuation running at the high rate costs.
+
+setDesign() takes the stopband attenuation in dB and the transition bandwidth as a fraction of the
+high sample rate (passband edge at 0.25 - transition / 2, stopband edge at 0.25 + transition / 2). The
+default transition of 0.25 puts the band edges at 0.25 and 0.75 of Nyquist, the same ones
+ButterworthHalfbandFilter is designed around. The number of sections follows from the two.
+*/
+
+#pragma once
+
+#include <vector>
+#include <span>
+
+namespace IADSP
+{
+    template<typename Type>
+    class AllpassHalfbandFilter
+    {
+    public:
+        AllpassHalfbandFilter(double stopbandAttenuationDB = 120.0, double transitionBandwidth = 0.25);
+
+        void setDesign(double stopbandAttenuationDB, double transitionBandwidth = 0.25);
+        void setNumChannels(int numChannels);
+        void reset() noexcept;
+        void snapToZero() noexcept;
+
+        int getNumCoefficients() const noexcept { return static_cast<int>(coefficients.size()); }
+
+        // make sure the output buffer is at least 2x the size of the input buffer
+        void interpolate(std::span<const Type> input, std::span<Type> output, int channel = 0) noexcept;
+        void interpolate(const Type* input, Type* output, size_t numInputSamples, int channel = 0) noexcept;
+
+        // make sure the input buffer is at least 2x the size of the output buffer
+        void decimate(std::span<const Type> input, std::span<Type> output, int channel = 0) noexcept;
+        void decimate(const Type* input, Type* output, size_t numOutputSamples, int channel = 0) noexcept;
+
+    private:
+        // per-channel allpass memories: the previous input and output of each section
+        struct ChannelState
+        {
+            std::vector<Type> x, y;
+        };
+
+        int numChannels = 1;
+
+        // even-indexed coefficients make up branch A0, odd-indexed ones branch A1
+        std::vector<Type> coefficients;
+        std::vector<ChannelState> states { 1 };
+    };
+}
@@ -1,10 +1,40 @@
 #include "ButterworthHalfbandFilter.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <numbers>
 
 namespace IADSP
 {
+    namespace
+    {
+        // one SecondOrderFilter lowpass step, with identical operation order so results stay bit-exact
+        template<typename Type, typename Section>
+        inline Type processSection(const Section& s, Type in, Type& fbk1, Type& fbk2) noexcept
+        {
+            const auto hp = s.a0 * (in - (s.d * fbk1) - fbk2);
+            const auto bp = (s.a * hp) + fbk1;
+            const auto lp = (s.a * bp) + fbk2;
+
+            fbk1 = (s.a * hp) + bp;
+            fbk2 = (s.a * bp) + lp;
+            return lp;
+        }
+
+        // the same step for a zero input sample: 0 - x - y == -x - y exactly, so nothing changes but the work
+        template<typename Type, typename Section>
+        inline Type processSectionZeroInput(const Section& s, Type& fbk1, Type& fbk2) noexcept
+        {
+            const auto hp = s.a0 * (-(s.d * fbk1) - fbk2);
+            const auto bp = (s.a * hp) + fbk1;
+            const auto lp = (s.a * bp) + fbk2;
+
+            fbk1 = (s.a * hp) + bp;
+            fbk2 = (s.a * bp) + lp;
+            return lp;
+        }
+    }
+
     template<typename Type>
     ButterworthHalfbandFilter<Type>::ButterworthHalfbandFilter(int filterOrder)
     {
@@ -27,17 +57,23 @@ namespace IADSP
         const auto numSections = order / 2;
         sections.resize(numSections);
 
+        // cutoff 0.25 at a sample rate of 2, i.e. a quarter of the post-doubling Nyquist
+        const auto one = static_cast<Type>(1.0);
+        const auto a = static_cast<Type>(std::tan(std::numbers::pi * 0.25 * 0.5));
+
         for(int k = 1; k <= numSections; ++k)
         {
             const auto theta = std::numbers::pi * (2 * k - 1) / (2.0 * order);
             const auto q = 1.0 / (2.0 * std::cos(theta));
-            const auto resonance = 1.0 - 1.0 / (2.0 * q);
+            const auto resonance = std::min(1.0 - 1.0 / (2.0 * q), 0.96875);
+
+            auto p = static_cast<Type>(1.0 - resonance);
+            p = p + p;
 
             auto& section = sections[k - 1];
-            section.setMode(SecondOrderFilterMode::Lowpass);
-            section.setSampleRate(2.0);
-            section.setCutoffFrequency(0.25);
-            section.setResonance(resonance);
+            section.a = a;
+            section.d = p + a;
+            section.a0 = one / (one + (p * a) + (a * a));
         }
 
         setNumChannels(numChannels);
@@ -47,24 +83,46 @@ namespace IADSP
     void ButterworthHalfbandFilter<Type>::setNumChannels(int newNumChannels)
     {
         numChannels = newNumChannels;
-        for(auto& section : sections) {
-            section.setNumChannels(numChannels);
+        states.resize(numChannels);
+        for(auto& state : states)
+        {
+            state.fbk1.resize(sections.size());
+            state.fbk2.resize(sections.size());
         }
+
+        reset();
     }
 
     template<typename Type>
     void ButterworthHalfbandFilter<Type>::reset() noexcept
     {
-        for(auto& section : sections) {
-            section.reset();
+        const auto zero = static_cast<Type>(0.0);
+        for(auto& state : states)
+        {
+            std::fill(state.fbk1.begin(), state.fbk1.end(), zero);
+            std::fill(state.fbk2.begin(), state.fbk2.end(), zero);
         }
     }
 
     template<typename Type>
     void ButterworthHalfbandFilter<Type>::snapToZero() noexcept
     {
-        for(auto& section : sections) {
-            section.snapToZero();
+        const auto zero = static_cast<Type>(0.0);
+        const auto min  = static_cast<Type>(1.0e-8);
+
+        for(auto& state : states)
+        {
+            for(auto& f : state.fbk1) {
+                if (! (f < -min || f > min)) {
+                    f = zero;
+                }
+            }
+
+            for(auto& f : state.fbk2) {
+                if (! (f < -min || f > min)) {
+                    f = zero;
+                }
+            }
         }
     }
 
@@ -72,19 +130,25 @@ namespace IADSP
     void ButterworthHalfbandFilter<Type>::interpolate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
     {
         const auto two = static_cast<Type>(2.0);
-        const auto zero = static_cast<Type>(0.0);
+        const auto* s = sections.data();
+        const auto numSections = sections.size();
+        auto* fbk1 = states[channel].fbk1.data();
+        auto* fbk2 = states[channel].fbk2.data();
 
         for(size_t i = 0; i < input.size(); ++i)
         {
-            output[2 * i] = two * input[i];
-            output[2 * i + 1] = zero;
-        }
-
-        for(auto& section : sections)
-        {
-            for(size_t n = 0; n < output.size(); ++n) {
-                output[n] = section.processSample(output[n], channel);
+            // the even sample is the (gain-compensated) input, the odd one the stuffed zero
+            auto even = processSection(s[0], two * input[i], fbk1[0], fbk2[0]);
+            auto odd = processSectionZeroInput(s[0], fbk1[0], fbk2[0]);
+
+            for(size_t k = 1; k < numSections; ++k)
+            {
+                even = processSection(s[k], even, fbk1[k], fbk2[k]);
+                odd = processSection(s[k], odd, fbk1[k], fbk2[k]);
             }
+
+            output[2 * i] = even;
+            output[2 * i + 1] = odd;
         }
     }
 
@@ -97,19 +161,25 @@ namespace IADSP
     template<typename Type>
     void ButterworthHalfbandFilter<Type>::decimate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
     {
+        const auto* s = sections.data();
+        const auto numSections = sections.size();
+        auto* fbk1 = states[channel].fbk1.data();
+        auto* fbk2 = states[channel].fbk2.data();
+
         for(size_t i = 0; i < output.size(); ++i)
         {
-            auto value = input[2 * i];
-            for(auto& section : sections) {
-                value = section.processSample(value, channel);
-            }
-
-            value = input[2 * i + 1];
-            for(auto& section : sections) {
-                value = section.processSample(value, channel);
+            auto even = input[2 * i];
+            auto odd = input[2 * i + 1];
+
+            // only the odd sample's output is kept, but the even one still has to pass through to
+            // advance every section's state
+            for(size_t k = 0; k < numSections; ++k)
+            {
+                even = processSection(s[k], even, fbk1[k], fbk2[k]);
+                odd = processSection(s[k], odd, fbk1[k], fbk2[k]);
             }
 
-            output[i] = value;
+            output[i] = odd;
         }
     }
 
@@ -1,7 +1,8 @@
 /*
-This is a halfband IIR lowpass filter built from a cascade of IADSP::SecondOrderFilter sections, used to
-interpolate a signal up by 2x (with anti-imaging filtering) or decimate it back down by 2x (with
-anti-aliasing filtering). IMPORTANT: do not use it to do both.
+This is a halfband IIR lowpass filter built from a cascade of state-variable second-order sections (the
+same topology and coefficients as IADSP::SecondOrderFilter in lowpass mode), used to interpolate a signal
+up by 2x (with anti-imaging filtering) or decimate it back down by 2x (with anti-aliasing filtering).
+IMPORTANT: do not use it to do both.
 
 It is intended for use as the second and later 2x stages of a multi-stage
 oversampling chain (see Oversampler), where the cheaper, non-linear-phase IIR design is an acceptable
@@ -11,13 +12,19 @@ The cutoff is fixed (always designed as a halfband filter: passband edge at 0.25
 Nyquist), but the order is configurable via setOrder() - later oversampling stages don't need as much
 attenuation as the first one, so a lower (and cheaper) order is usually appropriate there. Order must be
 even, since each section is one second-order biquad; odd values are rounded up to the next even value.
+
+Both interpolate() and decimate() step the whole cascade two high-rate samples (one low-rate sample) at
+a time, depth first, rather than running each section over the whole block in turn. The sections are
+evaluated here directly instead of through SecondOrderFilter::processSample(), so there is no per-sample
+coefficient-update check or mode switch, and the odd sample of each interpolated pair - the zero that
+would have been stuffed in - skips the input term in the first section altogether. The arithmetic is
+otherwise exactly SecondOrderFilter's, so the output is bit-for-bit what a cascade of those produces.
 */
 
 #pragma once
 
 #include <vector>
 #include <span>
-#include "SecondOrderFilter.hpp"
 
 namespace IADSP
 {
@@ -41,9 +48,21 @@ namespace IADSP
         void decimate(const Type* input, Type* output, size_t numOutputSamples, int channel = 0) noexcept;
 
     private:
+        struct Section
+        {
+            Type a0, a, d;
+        };
+
+        // per-channel integrator states, numSections of each
+        struct ChannelState
+        {
+            std::vector<Type> fbk1, fbk2;
+        };
+
         int order = 0;
         int numChannels = 1;
 
-        std::vector<SecondOrderFilter<Type>> sections;
+        std::vector<Section> sections;
+        std::vector<ChannelState> states { 1 };
     };
 }
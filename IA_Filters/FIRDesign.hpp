@@ -0,0 +1,134 @@
+/*
+Kaiser-window FIR design helpers, all constexpr so a fixed design can be baked into a static table at
+compile time (see HalfbandFIRFilter's designs), while still being usable at runtime for designs whose
+parameters are only known then (sample-rate ratios and the like).
+
+<cmath> isn't constexpr in C++20, so the handful of functions a Kaiser design needs (sqrt, exp, log and
+the modified Bessel function I0) are implemented here as plain series/iterations. They're accurate to
+double precision over the ranges a filter design uses them for, which is all they're meant for - they
+are not general-purpose replacements for the <cmath> versions.
+*/
+
+#pragma once
+
+#include <numbers>
+
+namespace IADSP
+{
+    namespace FIRDesign
+    {
+        constexpr double sqrt(double x)
+        {
+            if(x <= 0.0) {
+                return 0.0;
+            }
+
+            auto guess = x < 1.0 ? 1.0 : x;
+            for(int i = 0; i < 64; ++i)
+            {
+                const auto next = 0.5 * (guess + x / guess);
+                if(next == guess) {
+                    break;
+                }
+                guess = next;
+            }
+            return guess;
+        }
+
+        constexpr double exp(double x)
+        {
+            // halve the argument until the Taylor series converges quickly, then square back up
+            int halvings = 0;
+            while(x > 0.5 || x < -0.5)
+            {
+                x *= 0.5;
+                ++halvings;
+            }
+
+            double sum = 1.0, term = 1.0;
+            for(int k = 1; k < 30; ++k)
+            {
+                term *= x / k;
+                sum += term;
+            }
+
+            for(int i = 0; i < halvings; ++i) {
+                sum *= sum;
+            }
+            return sum;
+        }
+
+        constexpr double log(double x)
+        {
+            // x = m * 2^e with m in [0.5, 1), then ln(m) = 2 * atanh((m - 1) / (m + 1))
+            int exponent = 0;
+            while(x >= 1.0)
+            {
+                x *= 0.5;
+                ++exponent;
+            }
+            while(x < 0.5)
+            {
+                x *= 2.0;
+                --exponent;
+            }
+
+            const auto z = (x - 1.0) / (x + 1.0);
+            const auto z2 = z * z;
+            double sum = 0.0, power = z;
+            for(int k = 1; k < 80; k += 2)
+            {
+                sum += power / k;
+                power *= z2;
+            }
+            return 2.0 * sum + exponent * std::numbers::ln2;
+        }
+
+        // Modified Bessel function of the first kind, order 0, from its power series. <cmath> only has
+        // std::cyl_bessel_i (not constexpr, and not available on every standard library).
+        constexpr double besselI0(double x)
+        {
+            const auto halfXSquared = 0.25 * x * x;
+            double sum = 1.0, term = 1.0;
+            for(int k = 1; k < 200; ++k)
+            {
+                term *= halfXSquared / (static_cast<double>(k) * k);
+                sum += term;
+                if(term < sum * 1.0e-17) {
+                    break;
+                }
+            }
+            return sum;
+        }
+
+        // Kaiser's empirical beta for a given stopband attenuation in dB
+        constexpr double kaiserBeta(double attenuationDB)
+        {
+            if(attenuationDB > 50.0) {
+                return 0.1102 * (attenuationDB - 8.7);
+            }
+            if(attenuationDB >= 21.0) {
+                return 0.5842 * exp(0.4 * log(attenuationDB - 21.0)) + 0.07886 * (attenuationDB - 21.0);
+            }
+            return 0.0;
+        }
+
+        // Kaiser window value at a continuous position x in [-1, 1] (-1 and 1 are the two ends, peak of 1 at
+        // the centre), for kernels that are sampled at fractional offsets
+        constexpr double kaiserWindow(double x, double beta)
+        {
+            const auto r = 1.0 - x * x;
+            return besselI0(beta * sqrt(r > 0.0 ? r : 0.0)) / besselI0(beta);
+        }
+
+        // the same window for tap n of a length-tap window (symmetric)
+        constexpr double kaiserWindow(int n, int length, double beta)
+        {
+            if(length <= 1) {
+                return 1.0;
+            }
+
+            return kaiserWindow((2.0 * n) / (length - 1) - 1.0, beta);
+        }
+    }
+}
@@ -1,170 +1,243 @@
 #include "HalfbandFIRFilter.hpp"
-#include <cmath>
-#include <numbers>
 #include <algorithm>
 
 namespace IADSP
 {
-    // Modified Bessel function of the first kind, order 0 - the standard Abramowitz & Stegun
-    // polynomial approximation. Needed for the Kaiser window; <cmath> only has std::cyl_bessel_i,
-    // which is the unmodified Bessel function and not usable here.
-    double besselI0(double x)
-    {
-        const double ax = std::abs(x);
-        if (ax < 3.75)
-        {
-            const double t = (x / 3.75) * (x / 3.75);
-            return 1.0 + t * (3.5156229 + t * (3.0899424 + t * (1.2067492 +
-                    t * (0.2659732 + t * (0.0360768 + t * 0.0045813)))));
-        }
+    //===== Block History =====
 
-        const double t = 3.75 / ax;
-        const double poly = 0.39894228 + t * (0.01328592 + t * (0.00225319 +
-                                t * (-0.00157565 + t * (0.00916281 + t * (-0.02057706 +
-                                t * (0.02635537 + t * (-0.01647633 + t * 0.00392377)))))));
-        return (std::exp(ax) / std::sqrt(ax)) * poly;
-    }
-
-    //===== History Buffer =====
-
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::HistoryBuffer::setLength(int newLength)
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::BlockHistory::setStride(size_t newStride)
     {
-        length = newLength;
-        buffer.assign(static_cast<size_t>(length) * 2, static_cast<Type>(0.0));
-        writePos = 0;
+        stride = newStride;
+        buffer.assign(static_cast<size_t>(historyLength + blockLength) * stride, static_cast<Type>(0.0));
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::HistoryBuffer::clear()
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::BlockHistory::clear()
     {
         std::fill(buffer.begin(), buffer.end(), static_cast<Type>(0.0));
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::HistoryBuffer::push(Type sample)
-    {
-        writePos = (writePos + 1 == length) ? 0 : writePos + 1;
-        buffer[writePos] = sample;
-        buffer[writePos + length] = sample;
-    }
-
-    template<typename Type>
-    Type HalfbandFIRFilter<Type>::HistoryBuffer::read(int lookback) const
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::BlockHistory::retain(size_t numNewFrames) noexcept
     {
-        return buffer[writePos + length - lookback];
+        // the source always starts after the destination, so a forward copy is safe even when they overlap
+        const auto* source = buffer.data() + numNewFrames * stride;
+        std::copy(source, source + static_cast<size_t>(historyLength) * stride, buffer.data());
     }
 
     //===== FIR Filter =====
 
-    template<typename Type>
-    HalfbandFIRFilter<Type>::HalfbandFIRFilter()
+    template<typename Type, typename Design>
+    HalfbandFIRFilter<Type, Design>::HalfbandFIRFilter()
     {
-        constexpr int M = (numTaps - 1) / 2;
-        constexpr double beta = 10.06126;
-        const double i0Beta = besselI0(beta);
-
-        for(int n = 0; n < numTaps; ++n)
-        {
-            const int k = n - M;
-            double hIdeal;
-
-            if(k == 0) {
-                hIdeal = 0.5;
-            }
-            else if(k % 2 == 0) {
-                hIdeal = 0.0;
-            }
-            else {
-                hIdeal = std::sin(std::numbers::pi * k / 2.0) / (std::numbers::pi * k);
-            }
-
-            const double x = (2.0 * n) / (numTaps - 1) - 1.0;
-            const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - x * x))) / i0Beta;
-
-            if(n % 2 == 1) {
-                oddTaps[(n - 1) / 2] = hIdeal * window;
-            }
-        }
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::setNumChannels(int numChannels)
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::setNumChannels(int newNumChannels)
     {
+        numChannels = newNumChannels;
+
         upHistory.resize(numChannels);
-        downHistory.resize(numChannels);
+        downEvenHistory.resize(numChannels);
+        downOddHistory.resize(numChannels);
 
         for(auto& h : upHistory) {
-            h.setLength(upHistoryLength);
+            h.setStride(1);
         }
 
-        for(auto& h : downHistory) {
-            h.setLength(downHistoryLength);
+        for(auto& h : downEvenHistory) {
+            h.setStride(1);
         }
+
+        for(auto& h : downOddHistory) {
+            h.setStride(1);
+        }
+
+        const auto stride = static_cast<size_t>(((numChannels + laneWidth - 1) / laneWidth) * laneWidth);
+        multichannelUpHistory.setStride(stride);
+        multichannelDownEvenHistory.setStride(stride);
+        multichannelDownOddHistory.setStride(stride);
+        multichannelAccumulator.assign(stride, static_cast<Type>(0.0));
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::reset()
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::reset()
     {
         for(auto& h : upHistory) {
             h.clear();
         }
 
-        for(auto& h : downHistory) {
+        for(auto& h : downEvenHistory) {
+            h.clear();
+        }
+
+        for(auto& h : downOddHistory) {
             h.clear();
         }
+
+        multichannelUpHistory.clear();
+        multichannelDownEvenHistory.clear();
+        multichannelDownOddHistory.clear();
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::interpolate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::interpolate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
     {
         auto& history = upHistory[channel];
 
-        for(size_t i = 0; i < input.size(); ++i)
+        for(size_t start = 0; start < input.size(); start += blockLength)
         {
-            history.push(input[i]);
-
-            output[2 * i] = history.read(33);
-
-            double acc = 0.0;
-            for(int j = 0; j < numOddTaps; ++j) {
-                acc += oddTaps[j] * static_cast<double>(history.read(j));
+            const auto count = std::min(input.size() - start, static_cast<size_t>(blockLength));
+            std::copy(input.begin() + start, input.begin() + start + count, history.block());
+
+            const auto* x = history.frames();
+            auto* out = output.data() + 2 * start;
+
+            for(size_t i = 0; i < count; ++i)
+            {
+                // x[historyLength + i] is this input sample; the taps are symmetric, so the oldest-first
+                // run of the last numOddTaps samples can be used as-is
+                const auto centre = x[historyLength + i - interpolateCentreLag];
+                const auto filtered = static_cast<Type>(2.0) * VectorOps::dotProduct(oddTaps.data(), x + i + 1, numOddTaps);
+                out[2 * i] = centreOnEvenPhase ? centre : filtered;
+                out[2 * i + 1] = centreOnEvenPhase ? filtered : centre;
             }
-            output[2 * i + 1] = static_cast<Type>(2.0 * acc);
+
+            history.retain(count);
         }
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::interpolate(const Type* input, Type* output, size_t numInputSamples, int channel) noexcept
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::interpolate(const Type* input, Type* output, size_t numInputSamples, int channel) noexcept
     {
         interpolate(std::span<const Type>(input, numInputSamples), std::span<Type>(output, 2 * numInputSamples), channel);
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::decimate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::decimate(std::span<const Type> input, std::span<Type> output, int channel) noexcept
     {
-        auto& history = downHistory[channel];
+        auto& evenHistory = downEvenHistory[channel];
+        auto& oddHistory = downOddHistory[channel];
 
-        for(size_t i = 0; i < output.size(); ++i)
+        for(size_t start = 0; start < output.size(); start += blockLength)
         {
-            history.push(input[2 * i]);
-            history.push(input[2 * i + 1]);
+            const auto count = std::min(output.size() - start, static_cast<size_t>(blockLength));
+            auto* evenBlock = evenHistory.block();
+            auto* oddBlock = oddHistory.block();
+            const auto* in = input.data() + 2 * start;
+
+            for(size_t i = 0; i < count; ++i)
+            {
+                evenBlock[i] = in[2 * i];
+                oddBlock[i] = in[2 * i + 1];
+            }
 
-            double acc = 0.5 * static_cast<double>(history.read(67));
-            for(int j = 0; j < numOddTaps; ++j) {
-                acc += oddTaps[j] * static_cast<double>(history.read(2 + 2 * j));
+            const auto* centrePhase = centreOnEvenPhase ? evenHistory.frames() : oddHistory.frames();
+            const auto* tapPhase = (centreOnEvenPhase ? oddHistory.frames() : evenHistory.frames()) + tapPhaseOffset;
+            auto* out = output.data() + start;
+
+            for(size_t i = 0; i < count; ++i) {
+                out[i] = static_cast<Type>(0.5) * centrePhase[historyLength + i - decimateCentreLag]
+                            + VectorOps::dotProduct(oddTaps.data(), tapPhase + i, numOddTaps);
             }
-            output[i] = static_cast<Type>(acc);
+
+            evenHistory.retain(count);
+            oddHistory.retain(count);
         }
     }
 
-    template<typename Type>
-    void HalfbandFIRFilter<Type>::decimate(const Type* input, Type* output, size_t numOutputSamples, int channel) noexcept
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::decimate(const Type* input, Type* output, size_t numOutputSamples, int channel) noexcept
     {
         decimate(std::span<const Type>(input, 2 * numOutputSamples), std::span<Type>(output, numOutputSamples), channel);
     }
 
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::interpolate(const Type* const* input, Type* const* output, size_t numInputSamples) noexcept
+    {
+        auto& history = multichannelUpHistory;
+        auto* acc = multichannelAccumulator.data();
+        const auto stride = history.stride;
+
+        for(size_t start = 0; start < numInputSamples; start += blockLength)
+        {
+            const auto count = std::min(numInputSamples - start, static_cast<size_t>(blockLength));
+
+            auto* block = history.block();
+            for(int c = 0; c < numChannels; ++c)
+            {
+                const auto* in = input[c] + start;
+                for(size_t i = 0; i < count; ++i) {
+                    block[i * stride + static_cast<size_t>(c)] = in[i];
+                }
+            }
+
+            const auto* frames = history.frames();
+            const auto centreSlot = centreOnEvenPhase ? 0 : 1;
+            for(size_t i = 0; i < count; ++i)
+            {
+                VectorOps::weightedFrameSum(acc, frames + (i + 1) * stride, oddTaps.data(), numOddTaps, stride);
+
+                const auto* centre = frames + (historyLength + i - interpolateCentreLag) * stride;
+                const auto outPos = 2 * (start + i);
+                for(int c = 0; c < numChannels; ++c)
+                {
+                    output[c][outPos + centreSlot] = centre[c];
+                    output[c][outPos + 1 - centreSlot] = static_cast<Type>(2.0) * acc[c];
+                }
+            }
+
+            history.retain(count);
+        }
+    }
+
+    template<typename Type, typename Design>
+    void HalfbandFIRFilter<Type, Design>::decimate(const Type* const* input, Type* const* output, size_t numOutputSamples) noexcept
+    {
+        auto& evenHistory = multichannelDownEvenHistory;
+        auto& oddHistory = multichannelDownOddHistory;
+        auto* acc = multichannelAccumulator.data();
+        const auto stride = evenHistory.stride;
+
+        for(size_t start = 0; start < numOutputSamples; start += blockLength)
+        {
+            const auto count = std::min(numOutputSamples - start, static_cast<size_t>(blockLength));
+
+            auto* evenBlock = evenHistory.block();
+            auto* oddBlock = oddHistory.block();
+            for(int c = 0; c < numChannels; ++c)
+            {
+                const auto* in = input[c] + 2 * start;
+                for(size_t i = 0; i < count; ++i)
+                {
+                    evenBlock[i * stride + static_cast<size_t>(c)] = in[2 * i];
+                    oddBlock[i * stride + static_cast<size_t>(c)] = in[2 * i + 1];
+                }
+            }
+
+            const auto* centrePhase = centreOnEvenPhase ? evenHistory.frames() : oddHistory.frames();
+            const auto* tapPhase = (centreOnEvenPhase ? oddHistory.frames() : evenHistory.frames()) + tapPhaseOffset * stride;
+            for(size_t i = 0; i < count; ++i)
+            {
+                VectorOps::weightedFrameSum(acc, tapPhase + i * stride, oddTaps.data(), numOddTaps, stride);
+
+                const auto* centre = centrePhase + (historyLength + i - decimateCentreLag) * stride;
+                for(int c = 0; c < numChannels; ++c) {
+                    output[c][start + i] = static_cast<Type>(0.5) * centre[c] + acc[c];
+                }
+            }
+
+            evenHistory.retain(count);
+            oddHistory.retain(count);
+        }
+    }
+
     //==============================================================================
-    template class HalfbandFIRFilter<float>;
-    template class HalfbandFIRFilter<double>;
+    template class HalfbandFIRFilter<float, HalfbandFIRDesigns::LowLatency>;
+    template class HalfbandFIRFilter<float, HalfbandFIRDesigns::Balanced>;
+    template class HalfbandFIRFilter<float, HalfbandFIRDesigns::HighQuality>;
+    template class HalfbandFIRFilter<double, HalfbandFIRDesigns::LowLatency>;
+    template class HalfbandFIRFilter<double, HalfbandFIRDesigns::Balanced>;
+    template class HalfbandFIRFilter<double, HalfbandFIRDesigns::HighQuality>;
 }
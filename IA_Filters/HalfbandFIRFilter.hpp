@@ -4,13 +4,40 @@ filtering) or decimate it back down by 2x (with anti-aliasing filtering). It is
 first 2x stage of a multi-stage oversampling chain (see Oversampler), where a linear-phase filter is
 worth the extra cost relative to the IIR filters used for any later stages.
 
-The design is a 133-tap Kaiser-windowed halfband lowpass (passband edge at 0.45 of the post-doubling
-Nyquist, ~100dB stopband attenuation), exploiting the standard halfband property that every other tap is
-exactly zero. Only the 66 nonzero taps are ever multiplied, evaluated once per sample at the lower of the
-two sample rates involved (the classic polyphase-halfband efficiency trick).
+Each design is a Kaiser-windowed halfband lowpass, chosen at compile time through the Design template
+parameter: a HalfbandFIRDesign<NumTaps, StopbandDB>, whose coefficients are generated by constexpr code
+(see FIRDesign.hpp) into a static table. Three named presets are provided in HalfbandFIRDesigns:
+    LowLatency  - 31 taps, 60dB stopband,  15 samples of round-trip latency, for live monitoring
+    Balanced    - 63 taps, 80dB stopband,  31 samples of round-trip latency
+    HighQuality - 133 taps, 100dB stopband, 66 samples of round-trip latency (the default, and the
+                  original fixed design: passband edge at 0.45 of the post-doubling Nyquist)
+Fewer taps buy lower latency and fewer cycles at the cost of a wider transition band for a given
+stopband. Other designs work too, but need adding to the explicit instantiations in
+HalfbandFIRFilter.cpp.
 
-The design is fixed (no runtime quality knob) and is independent of the absolute sample rate it ends up
-running at, since it is specified purely in terms of fractions of Nyquist.
+Every design exploits the standard halfband property that every other tap is exactly zero. Only the
+nonzero taps are ever multiplied, evaluated once per sample at the lower of the two sample rates involved
+(the classic polyphase-halfband efficiency trick).
+
+History is kept block-contiguous rather than as a per-sample ring: each channel's buffer holds the last
+numOddTaps input samples as a prefix, linearly followed by the incoming block (up to blockLength samples
+at a time). The filter then runs as a plain FIR over contiguous memory - no wrapping index or mirrored
+double store inside the inner loop - and only the tail is copied back to the front once per block. The
+decimator splits its input into even and odd phases as it copies them in, so both of its histories are
+unit-stride too.
+
+The dot product is the hot loop of an oversampled chain, so it runs through the SIMD kernels in
+IA_Utilities/VectorOps.hpp: float filters accumulate in float lanes, double filters in double lanes.
+
+For larger channel counts there is also a multichannel mode (the Type* const* overloads below), which
+filters every channel set by setNumChannels() in one pass over the coefficients. Its history is stored
+interleaved by channel (one frame per sample, padded to a whole number of SIMD registers), so a single
+register holds the same tap for 4 or 8 channels and each coefficient is broadcast once and shared by all
+of them. The planar and multichannel overloads keep separate histories - pick one style per instance
+rather than mixing them.
+
+A design has no runtime quality knob and is independent of the absolute sample rate it ends up running
+at, since it is specified purely in terms of fractions of Nyquist.
 */
 
 #pragma once
@@ -19,13 +46,61 @@ running at, since it is specified purely in terms of fractions of Nyquist.
 #include <array>
 #include <cstddef>
 #include <span>
+#include <algorithm>
+#include <numbers>
+#include "FIRDesign.hpp"
+#include "../IA_Utilities/VectorOps.hpp"
 
 namespace IADSP
 {
-    template<typename Type>
+    template<int NumTaps, int StopbandDB>
+    struct HalfbandFIRDesign
+    {
+        static_assert(NumTaps >= 7 && NumTaps % 2 == 1, "a halfband design needs an odd number of taps");
+
+        static constexpr int numTaps = NumTaps;
+        static constexpr int centre = (NumTaps - 1) / 2;
+
+        // taps at an odd offset from the centre - the only nonzero ones apart from the centre tap itself
+        static constexpr int numOddTaps = (centre % 2 == 0) ? centre : centre + 1;
+
+        // group delay of interpolate() followed by decimate(), in low-rate samples
+        static constexpr int roundTripLatency = centre;
+
+        static constexpr std::array<double, numOddTaps> makeOddTaps()
+        {
+            const auto beta = FIRDesign::kaiserBeta(static_cast<double>(StopbandDB));
+            std::array<double, numOddTaps> taps {};
+
+            for(int j = 0; j < numOddTaps; ++j)
+            {
+                // offset k from the centre is odd, so sin(pi * k / 2) is just +/-1
+                const auto n = 2 * j + ((centre % 2 == 0) ? 1 : 0);
+                const auto k = n - centre;
+                const auto sign = (((k % 4) + 4) % 4 == 1) ? 1.0 : -1.0;
+                const auto hIdeal = sign / (std::numbers::pi * k);
+                taps[j] = hIdeal * FIRDesign::kaiserWindow(n, numTaps, beta);
+            }
+
+            return taps;
+        }
+
+        static constexpr std::array<double, numOddTaps> oddTaps = makeOddTaps();
+    };
+
+    namespace HalfbandFIRDesigns
+    {
+        using LowLatency = HalfbandFIRDesign<31, 60>;
+        using Balanced = HalfbandFIRDesign<63, 80>;
+        using HighQuality = HalfbandFIRDesign<133, 100>;
+    }
+
+    template<typename Type, typename Design = HalfbandFIRDesigns::HighQuality>
     class HalfbandFIRFilter
     {
     public:
+        static constexpr int roundTripLatency = Design::roundTripLatency;
+
         HalfbandFIRFilter();
 
         void setNumChannels(int numChannels);
@@ -39,27 +114,69 @@ namespace IADSP
         void decimate(std::span<const Type> input, std::span<Type> output, int channel = 0) noexcept;
         void decimate(const Type* input, Type* output, size_t numOutputSamples, int channel = 0) noexcept;
 
+        // multichannel mode: every channel at once, numInputSamples per channel in -> 2 * numInputSamples out
+        void interpolate(const Type* const* input, Type* const* output, size_t numInputSamples) noexcept;
+
+        // multichannel mode: every channel at once, 2 * numOutputSamples per channel in -> numOutputSamples out
+        void decimate(const Type* const* input, Type* const* output, size_t numOutputSamples) noexcept;
+
     private:
-        static constexpr int numTaps = 133;
-        static constexpr int numOddTaps = 66;
-        static constexpr int upHistoryLength = 66;
-        static constexpr int downHistoryLength = 133;
+        static constexpr int numOddTaps = Design::numOddTaps;
+        static constexpr int historyLength = numOddTaps;
+
+        // Which output (interpolating) or input (decimating) phase the centre tap lands on depends on
+        // whether the design's centre index is even; the odd taps always work on the other phase.
+        static constexpr bool centreOnEvenPhase = Design::centre % 2 == 0;
+        static constexpr int interpolateCentreLag = Design::centre / 2;
+        static constexpr int decimateCentreLag = (Design::centre + 1) / 2;
+
+        // When the odd taps work on the even input phase they include the current pair's even sample,
+        // so their window ends one frame later than it does on the odd phase.
+        static constexpr size_t tapPhaseOffset = centreOnEvenPhase ? 0 : 1;
+        static constexpr int blockLength = 128;
 
-        struct HistoryBuffer
+        // The last historyLength frames of input, followed by room for up to blockLength new ones. A frame
+        // is `stride` samples wide: 1 for the planar histories, or one sample per channel (zero-padded up
+        // to the SIMD register width) for the interleaved multichannel ones.
+        struct BlockHistory
         {
             std::vector<Type> buffer;
-            int length = 0;
-            int writePos = 0;
+            size_t stride = 1;
 
-            void setLength(int newLength);
+            void setStride(size_t newStride);
             void clear();
-            void push(Type sample);
-            Type read(int lookback) const;
+
+            // where the next block's frames should be written
+            Type* block() noexcept { return buffer.data() + historyLength * stride; }
+
+            // frame 0 is the oldest retained frame; frame historyLength is the block's first new frame
+            const Type* frames() const noexcept { return buffer.data(); }
+
+            // slides the newest historyLength frames down to the front, ready for the next block
+            void retain(size_t numNewFrames) noexcept;
         };
 
-        std::array<double, numOddTaps> oddTaps {};
+        static constexpr int laneWidth = std::max(1, static_cast<int>(VectorOps::registerBytes / sizeof(Type)));
+
+        static constexpr std::array<Type, numOddTaps> makeTypedTaps()
+        {
+            std::array<Type, numOddTaps> taps {};
+            for(int j = 0; j < numOddTaps; ++j) {
+                taps[j] = static_cast<Type>(Design::oddTaps[j]);
+            }
+            return taps;
+        }
+
+        static constexpr std::array<Type, numOddTaps> oddTaps = makeTypedTaps();
+
+        std::vector<BlockHistory> upHistory;
+        std::vector<BlockHistory> downEvenHistory;
+        std::vector<BlockHistory> downOddHistory;
 
-        std::vector<HistoryBuffer> upHistory;
-        std::vector<HistoryBuffer> downHistory;
+        int numChannels = 0;
+        BlockHistory multichannelUpHistory;
+        BlockHistory multichannelDownEvenHistory;
+        BlockHistory multichannelDownOddHistory;
+        std::vector<Type> multichannelAccumulator;
     };
 }
@@ -0,0 +1,423 @@
+#include "PartitionedConvolver.hpp"
+#include "../IA_Utilities/VectorOps.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace IADSP
+{
+    namespace
+    {
+        constexpr bool isPowerOfTwo(int x) noexcept
+        {
+            return x > 0 && (x & (x - 1)) == 0;
+        }
+
+        // accumulator += a * b over numBins interleaved complex values, spelt out on the real and imaginary
+        // parts so it vectorises (std::complex's operator* has to handle inf/nan and usually doesn't)
+        template<typename Type>
+        void complexMultiplyAccumulate(std::complex<Type>* accumulator, const std::complex<Type>* a, const std::complex<Type>* b, size_t numBins) noexcept
+        {
+            auto* acc = reinterpret_cast<Type*>(accumulator);
+            const auto* x = reinterpret_cast<const Type*>(a);
+            const auto* y = reinterpret_cast<const Type*>(b);
+
+            for(size_t k = 0; k < 2 * numBins; k += 2)
+            {
+                acc[k] += x[k] * y[k] - x[k + 1] * y[k + 1];
+                acc[k + 1] += x[k] * y[k + 1] + x[k + 1] * y[k];
+            }
+        }
+    }
+
+    template<typename Type>
+    PartitionedConvolver<Type>::PartitionedConvolver() = default;
+
+    template<typename Type>
+    PartitionedConvolver<Type>::~PartitionedConvolver()
+    {
+        stopThreads();
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::setHeadLength(int numSamples)
+    {
+        assert(isPowerOfTwo(numSamples));
+        headLength = isPowerOfTwo(numSamples) ? numSamples : 64;
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::setMaxPartitionSize(int numSamples)
+    {
+        assert(isPowerOfTwo(numSamples));
+        maxPartitionSize = isPowerOfTwo(numSamples) ? numSamples : 8192;
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::setUseBackgroundThreads(bool shouldUseThreads)
+    {
+        useBackgroundThreads = shouldUseThreads;
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::setImpulseResponse(const Type* const* impulses, int numImpulseChannels, size_t length)
+    {
+        assert(numImpulseChannels > 0);
+
+        impulseResponses.clear();
+        for(int c = 0; c < numImpulseChannels; ++c) {
+            impulseResponses.emplace_back(impulses[c], impulses[c] + length);
+        }
+        impulseLength = length;
+
+        if(prepared) {
+            build();
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::setImpulseResponse(const Type* impulse, size_t length)
+    {
+        setImpulseResponse(&impulse, 1, length);
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::prepare(int newNumChannels, int newMaximumBlockSize)
+    {
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+        prepared = true;
+        build();
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::build()
+    {
+        stopThreads();
+        levels.clear();
+
+        const auto head = static_cast<size_t>(headLength);
+        const auto maxSize = std::max(static_cast<size_t>(maxPartitionSize), head);
+        const auto numImpulseChannels = std::max<size_t>(impulseResponses.size(), 1);
+
+        // the head, with its taps reversed so the FIR is a plain dot product against the history
+        headTaps.assign(numImpulseChannels, std::vector<Type>(head, static_cast<Type>(0.0)));
+        for(size_t i = 0; i < impulseResponses.size(); ++i)
+        {
+            for(size_t k = 0; k < std::min(head, impulseLength); ++k) {
+                headTaps[i][head - 1 - k] = impulseResponses[i][k];
+            }
+        }
+
+        headHistory.assign(numChannels, std::vector<Type>(2 * head - 1, static_cast<Type>(0.0)));
+        headOutput.assign(numChannels, std::vector<Type>(head, static_cast<Type>(0.0)));
+
+        // the schedule: each level starts where the previous one stopped, and has as many partitions
+        // as it takes to reach the earliest point the next, larger, level can start from - its own
+        // partition size, or twice that for a background level
+        size_t start = head, size = head, maxStart = 0;
+        while(start < impulseLength)
+        {
+            const auto nextSize = std::min(4 * size, maxSize);
+            const auto remaining = (impulseLength - start + size - 1) / size;
+            size_t count = remaining;
+
+            if(nextSize != size)
+            {
+                const auto nextStart = nextSize * (useBackgroundThreads ? 2 : 1);
+                const auto needed = nextStart > start ? (nextStart - start + size - 1) / size : 1;
+                count = std::min(remaining, needed);
+            }
+
+            auto level = std::make_unique<Level>();
+            level->partitionSize = size;
+            level->start = start;
+            level->numPartitions = count;
+            level->background = useBackgroundThreads && size > head;
+            levels.push_back(std::move(level));
+
+            maxStart = std::max(maxStart, start);
+            start += count * size;
+            size = nextSize;
+        }
+
+        for(auto& level : levels)
+        {
+            const auto p = level->partitionSize;
+            const auto numBins = p + 1;
+            level->fft.setSize(2 * p);
+
+            level->partitions.assign(numImpulseChannels, std::vector<std::complex<Type>>(level->numPartitions * numBins));
+            level->timeDomain.assign(2 * p, static_cast<Type>(0.0));
+
+            for(size_t i = 0; i < impulseResponses.size(); ++i)
+            {
+                for(size_t j = 0; j < level->numPartitions; ++j)
+                {
+                    // partition j, zero-padded to the FFT size
+                    const auto first = level->start + j * p;
+                    const auto last = std::min(first + p, impulseLength);
+                    std::fill(level->timeDomain.begin(), level->timeDomain.end(), static_cast<Type>(0.0));
+                    std::copy(impulseResponses[i].begin() + first, impulseResponses[i].begin() + last, level->timeDomain.begin());
+                    level->fft.forward(level->timeDomain.data(), level->partitions[i].data() + j * numBins);
+                }
+            }
+
+            level->window.assign(numChannels, std::vector<Type>(2 * p, static_cast<Type>(0.0)));
+            level->result.assign(numChannels, std::vector<Type>(p, static_cast<Type>(0.0)));
+            level->fdl.assign(numChannels, std::vector<std::complex<Type>>(level->numPartitions * numBins));
+            level->accumulator.assign(numBins, {});
+
+            if(level->background)
+            {
+                level->jobInput.assign(numChannels, std::vector<Type>(2 * p, static_cast<Type>(0.0)));
+                level->thread = std::thread([this, raw = level.get()] { backgroundLoop(*raw); });
+            }
+        }
+
+        // everything a level adds is due within maxStart + its partition size of now
+        size_t ringSize = 1;
+        while(ringSize < maxStart + maxSize + head + 1) {
+            ringSize *= 2;
+        }
+        outputRing.assign(numChannels, std::vector<Type>(levels.empty() ? 0 : ringSize, static_cast<Type>(0.0)));
+        ringMask = ringSize - 1;
+
+        reset();
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::stopThreads() noexcept
+    {
+        for(auto& level : levels)
+        {
+            if(level->thread.joinable())
+            {
+                level->jobState.store(quit, std::memory_order_release);
+                level->jobState.notify_all();
+                level->thread.join();
+            }
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::reset() noexcept
+    {
+        for(auto& level : levels)
+        {
+            // a job still running would write into the buffers cleared below; its result is dropped
+            if(level->background)
+            {
+                waitForJob(*level);
+                level->jobState.store(idle, std::memory_order_relaxed);
+            }
+
+            for(auto& w : level->window) {
+                std::fill(w.begin(), w.end(), static_cast<Type>(0.0));
+            }
+            for(auto& f : level->fdl) {
+                std::fill(f.begin(), f.end(), std::complex<Type> {});
+            }
+            level->fdlPosition = 0;
+        }
+
+        for(auto& h : headHistory) {
+            std::fill(h.begin(), h.end(), static_cast<Type>(0.0));
+        }
+        for(auto& r : outputRing) {
+            std::fill(r.begin(), r.end(), static_cast<Type>(0.0));
+        }
+
+        position = 0;
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::waitForJob(Level& level) noexcept
+    {
+        while(level.jobState.load(std::memory_order_acquire) == queued) {
+            level.jobState.wait(queued, std::memory_order_acquire);
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::backgroundLoop(Level& level) noexcept
+    {
+        for(;;)
+        {
+            auto state = level.jobState.load(std::memory_order_acquire);
+            while(state != queued && state != quit)
+            {
+                level.jobState.wait(state, std::memory_order_acquire);
+                state = level.jobState.load(std::memory_order_acquire);
+            }
+
+            if(state == quit) {
+                return;
+            }
+
+            computeLevel(level, level.jobInput);
+
+            // the audio thread may have replaced a done with quit meanwhile, so only a queued job is
+            // marked done
+            auto expected = static_cast<int>(queued);
+            level.jobState.compare_exchange_strong(expected, done, std::memory_order_release, std::memory_order_acquire);
+            level.jobState.notify_all();
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::computeLevel(Level& level, const std::vector<std::vector<Type>>& input) noexcept
+    {
+        const auto p = level.partitionSize;
+        const auto numBins = p + 1;
+        const auto count = level.numPartitions;
+
+        level.fdlPosition = level.fdlPosition + 1 < count ? level.fdlPosition + 1 : 0;
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            const auto& partitions = level.partitions[std::min(static_cast<size_t>(c), level.partitions.size() - 1)];
+            auto* fdl = level.fdl[c].data();
+
+            // the newest input spectrum goes into the delay line, and partition j meets the one from
+            // j partitions ago
+            level.fft.forward(input[c].data(), fdl + level.fdlPosition * numBins);
+
+            std::fill(level.accumulator.begin(), level.accumulator.end(), std::complex<Type> {});
+            for(size_t j = 0; j < count; ++j)
+            {
+                const auto slot = level.fdlPosition >= j ? level.fdlPosition - j : level.fdlPosition + count - j;
+                complexMultiplyAccumulate(level.accumulator.data(), fdl + slot * numBins, partitions.data() + j * numBins, numBins);
+            }
+
+            // overlap-save: the first half of the circular convolution has wrapped round, the second is
+            // the output
+            level.fft.inverse(level.accumulator.data(), level.timeDomain.data());
+            std::copy(level.timeDomain.begin() + p, level.timeDomain.end(), level.result[c].begin());
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::addToOutput(const Level& level, size_t resultTime) noexcept
+    {
+        const auto p = level.partitionSize;
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            auto* ring = outputRing[c].data();
+            const auto* result = level.result[c].data();
+
+            for(size_t i = 0; i < p; ++i) {
+                ring[(resultTime + i) & ringMask] += result[i];
+            }
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::fireLevel(Level& level) noexcept
+    {
+        const auto p = level.partitionSize;
+
+        // the window holds the last 2p input samples, ending at position; the result covers the output
+        // from position - p + start, which the schedule guarantees hasn't been played yet
+        if(! level.background)
+        {
+            computeLevel(level, level.window);
+            addToOutput(level, position - p + level.start);
+        }
+        else
+        {
+            // the previous job, handed over one partition ago, is due now
+            waitForJob(level);
+            if(level.jobState.load(std::memory_order_acquire) == done) {
+                addToOutput(level, level.jobTime - p + level.start);
+            }
+
+            for(int c = 0; c < numChannels; ++c) {
+                std::copy(level.window[c].begin(), level.window[c].end(), level.jobInput[c].begin());
+            }
+            level.jobTime = position;
+            level.jobState.store(queued, std::memory_order_release);
+            level.jobState.notify_one();
+        }
+
+        for(auto& w : level.window) {
+            std::copy(w.begin() + p, w.end(), w.begin());
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::process(Type** buffer, size_t numSamples) noexcept
+    {
+        assert(numSamples <= static_cast<size_t>(maximumBlockSize));
+
+        const auto head = static_cast<size_t>(headLength);
+        size_t offset = 0;
+
+        // in chunks that end on multiples of the head length, which is where levels can fire
+        while(offset < numSamples)
+        {
+            const auto chunk = std::min(numSamples - offset, head - (position & (head - 1)));
+
+            for(int c = 0; c < numChannels; ++c)
+            {
+                const auto* taps = headTaps[std::min(static_cast<size_t>(c), headTaps.size() - 1)].data();
+                auto* history = headHistory[c].data();
+                auto* out = headOutput[c].data();
+
+                std::copy(buffer[c] + offset, buffer[c] + offset + chunk, history + head - 1);
+                for(size_t i = 0; i < chunk; ++i) {
+                    out[i] = VectorOps::dotProduct(taps, history + i, head);
+                }
+                std::copy(history + chunk, history + chunk + head - 1, history);
+            }
+
+            for(auto& level : levels)
+            {
+                const auto windowOffset = level->partitionSize + (position & (level->partitionSize - 1));
+                for(int c = 0; c < numChannels; ++c) {
+                    std::copy(buffer[c] + offset, buffer[c] + offset + chunk, level->window[c].begin() + windowOffset);
+                }
+            }
+
+            for(int c = 0; c < numChannels; ++c)
+            {
+                auto* out = buffer[c] + offset;
+                const auto* headOut = headOutput[c].data();
+
+                if(levels.empty()) {
+                    std::copy(headOut, headOut + chunk, out);
+                }
+                else
+                {
+                    auto* ring = outputRing[c].data();
+                    for(size_t i = 0; i < chunk; ++i)
+                    {
+                        auto& tail = ring[(position + i) & ringMask];
+                        out[i] = headOut[i] + tail;
+                        tail = static_cast<Type>(0.0);
+                    }
+                }
+            }
+
+            position += chunk;
+            offset += chunk;
+
+            for(auto& level : levels)
+            {
+                if((position & (level->partitionSize - 1)) == 0) {
+                    fireLevel(*level);
+                }
+            }
+        }
+    }
+
+    template<typename Type>
+    void PartitionedConvolver<Type>::process(AudioBuffer<Type>& buffer) noexcept
+    {
+        process(buffer.data(), buffer.numFrames());
+    }
+
+    //==============================================================================
+    template class PartitionedConvolver<float>;
+    template class PartitionedConvolver<double>;
+}
@@ -0,0 +1,148 @@
+/*
+This is a zero-latency convolver for long impulse responses (cabinets, and reverbs of several seconds),
+whose cost per sample stays close to constant however long the IR is.
+
+    convolver.setImpulseResponse(ir, irLength);     // or one IR per channel
+    convolver.prepare(numChannels, maximumBlockSize);
+    convolver.process(buffer, numSamples);           // in place, Type** or AudioBuffer<Type>
+
+The IR is split non-uniformly (after Gardner): its first setHeadLength() taps (64 by default) run as a
+direct FIR, sample by sample, so the output has no latency. The rest is covered by a series of levels,
+each a uniformly partitioned overlap-save FFT convolution (see RealFFT) whose partition size is four
+times the previous level's, up to setMaxPartitionSize() (8192 by default) - the last level repeats that
+size for as long as the IR needs. A level with partition size P collects P input samples, then does one
+2P-point FFT, multiplies it with each of its partitions' spectra against a frequency-domain delay line
+of past input spectra, and one inverse FFT; each level starts far enough into the IR that its result is
+due no earlier than the moment it becomes available. Short partitions early in the IR keep latency at
+zero, long ones later on keep the FFT work per sample low, and both together mean a 10 second IR costs
+only a few times what a 1 second one does.
+
+With setUseBackgroundThreads(true), every level above the first (i.e. every partition longer than the
+head) runs on a thread of its own instead, so the audio callback only does the head FIR and the
+shortest partitions. Those levels start twice as far into the IR, which gives each one a whole
+partition's worth of time to compute in: the audio thread hands a level its input when it has
+collected a partition, and picks up the result when the next partition is collected. If the
+machine can't keep up and a result isn't ready by then, the audio thread waits for it. The handoff
+itself is a single state atomic per level plus a notify (a futex or WaitOnAddress wake), with no locks
+and no allocation.
+
+Channels beyond the number of IR channels given use the last IR channel, so a mono IR serves any
+number of channels. The schedule, FFT plans and every buffer are built in setImpulseResponse() and
+prepare() (whichever comes last), which allocate and start the background threads - load a new IR off
+the audio thread. process() and reset() don't allocate.
+*/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include "../IA_Utilities/RealFFT.hpp"
+#include "../IA_Utilities/AudioBuffer.hpp"
+
+namespace IADSP
+{
+    template<typename Type>
+    class PartitionedConvolver
+    {
+    public:
+        PartitionedConvolver();
+        ~PartitionedConvolver();
+
+        PartitionedConvolver(const PartitionedConvolver&) = delete;
+        PartitionedConvolver& operator=(const PartitionedConvolver&) = delete;
+
+        // both must be powers of two; take effect at the next setImpulseResponse() or prepare()
+        void setHeadLength(int numSamples);
+        void setMaxPartitionSize(int numSamples);
+        void setUseBackgroundThreads(bool shouldUseThreads);
+
+        // impulses[c] is the IR for channel c, each of length samples; channels beyond numImpulseChannels
+        // use the last one
+        void setImpulseResponse(const Type* const* impulses, int numImpulseChannels, size_t length);
+        void setImpulseResponse(const Type* impulse, size_t length);
+
+        void prepare(int numChannels, int maximumBlockSize);
+        void reset() noexcept;
+
+        void process(Type** buffer, size_t numSamples) noexcept;
+        void process(AudioBuffer<Type>& buffer) noexcept;
+
+        size_t getLatency() const noexcept { return 0; }
+
+    private:
+        // one uniformly partitioned section of the IR: numPartitions partitions of partitionSize taps,
+        // starting start taps in
+        struct Level
+        {
+            size_t partitionSize = 0, start = 0, numPartitions = 0;
+            bool background = false;
+
+            RealFFT<Type> fft;
+
+            // per IR channel: the partitions' spectra, numPartitions * (partitionSize + 1) bins
+            std::vector<std::vector<std::complex<Type>>> partitions;
+
+            // per channel: the last 2 * partitionSize input samples, the frequency-domain delay line
+            // (numPartitions spectra, newest at fdlPosition), and the latest partitionSize outputs
+            std::vector<std::vector<Type>> window, result;
+            std::vector<std::vector<std::complex<Type>>> fdl;
+            size_t fdlPosition = 0;
+
+            std::vector<std::complex<Type>> accumulator;
+            std::vector<Type> timeDomain;
+
+            // background levels only: the window handed over to the thread, and when it was
+            std::vector<std::vector<Type>> jobInput;
+            size_t jobTime = 0;
+            std::atomic<int> jobState { 0 };
+            std::thread thread;
+        };
+
+        enum JobState { idle, queued, done, quit };
+
+        void build();
+        void stopThreads() noexcept;
+        void backgroundLoop(Level& level) noexcept;
+
+        // blocks until a background level's job, if one is queued, has finished
+        void waitForJob(Level& level) noexcept;
+
+        // runs a level's FFT convolution on input[c] (2 * partitionSize samples) into level.result
+        void computeLevel(Level& level, const std::vector<std::vector<Type>>& input) noexcept;
+
+        // called once a level's window has collected a whole new partition of input, the last of it being
+        // the sample just before the current position
+        void fireLevel(Level& level) noexcept;
+        void addToOutput(const Level& level, size_t resultTime) noexcept;
+
+        int headLength = 64;
+        int maxPartitionSize = 8192;
+        bool useBackgroundThreads = false;
+
+        std::vector<std::vector<Type>> impulseResponses;
+        size_t impulseLength = 0;
+
+        int numChannels = 0;
+        int maximumBlockSize = 0;
+        bool prepared = false;
+
+        // per IR channel, the head taps reversed; per channel, headLength - 1 samples of history
+        // followed by room for one chunk, and the head's output for that chunk
+        std::vector<std::vector<Type>> headTaps;
+        std::vector<std::vector<Type>> headHistory, headOutput;
+
+        std::vector<std::unique_ptr<Level>> levels;
+
+        // per channel: the levels' results, summed at the sample position they are due (modulo the
+        // ring size), and cleared again as they are played out
+        std::vector<std::vector<Type>> outputRing;
+        size_t ringMask = 0;
+
+        // samples processed since the last reset
+        size_t position = 0;
+    };
+}
@@ -0,0 +1,20 @@
+/*
+The cache line size the lock-free classes (FiFo.hpp, SnapshotPublisher.hpp) pad their shared state out
+to, so that data written by one thread doesn't sit on a line another thread keeps reading. 128 bytes on
+Apple Silicon, whose cores move lines around in 128-byte pairs, and 64 everywhere else.
+std::hardware_destructive_interference_size would be the standard spelling, but compilers warn that its
+value can differ between translation units, which is exactly what a class layout can't allow.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace IADSP
+{
+#if defined(__APPLE__) && defined(__aarch64__)
+    inline constexpr size_t cacheLineSize = 128;
+#else
+    inline constexpr size_t cacheLineSize = 64;
+#endif
+}
@@ -0,0 +1,120 @@
+/*
+A bounded lock-free single-producer/single-consumer queue of messages, for passing events rather than
+samples between the GUI/message thread and the audio thread: parameter changes with a sample offset,
+note on/off, "load this preset slot" and so on. It is Fifo for any trivially copyable struct instead of
+audio samples, and runs on the same positions (FifoPositions or PowerOfTwoFifoPositions) with the same
+acquire/release discipline, so a message is fully written before the consumer can see it and its slot
+isn't reused until the consumer has copied it out.
+
+    struct ParameterChange { int id; float value; int sampleOffset; };
+    EventQueue<ParameterChange> toAudio(256);
+
+    toAudio.push({ gainID, 0.5f, 0 });                     // GUI thread
+
+    std::array<ParameterChange, 64> changes;               // audio thread, once per block
+    const auto numChanges = toAudio.pop(changes);
+    for(int i = 0; i < numChanges; ++i) { ... }
+
+Messages come out in the order they went in. Nothing allocates after setSize(), and a push() to a full
+queue fails (returning false, or how many messages did fit) rather than blocking or growing, so the
+caller decides whether to drop, retry next block or coalesce. The batch pop() copies as many messages as
+fit into a span in at most two contiguous copies, with one pair of position updates for the whole batch.
+
+One thread may call push(); one other may call pop()/getNumReady(). For messages in both directions, use
+two queues. setSize()/reset() are for setup only. With the default FifoPositions a queue of size N holds
+N - 1 messages, like Fifo; PowerOfTwoFifoPositions holds all N of a power-of-two size.
+
+EventQueue is neither copyable nor movable (std::atomic members).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "FiFo.hpp"
+
+template<typename MessageType, typename Positions = FifoPositions>
+class EventQueue
+{
+public:
+    static_assert(std::is_trivially_copyable_v<MessageType>, "EventQueue messages are copied in and out of a shared ring");
+
+    EventQueue() {}
+
+    EventQueue(int size)
+    {
+        setSize(size);
+    }
+
+    void setSize(int numElements)
+    {
+        assert(numElements > 0);
+
+        positions.setSize(numElements);
+        messages.resize(static_cast<size_t>(numElements));
+        reset();
+    }
+
+    // drops every queued message
+    void reset() noexcept
+    {
+        positions.reset();
+    }
+
+    int size() const noexcept
+    {
+        return positions.size();
+    }
+
+    // consumer: how many messages are waiting
+    int getNumReady() const noexcept
+    {
+        return positions.getSizeToRead();
+    }
+
+    // producer: returns false, without queueing it, if the queue is full
+    bool push(const MessageType& message) noexcept
+    {
+        return push(std::span<const MessageType>(&message, 1)) == 1;
+    }
+
+    // producer: queues as many of newMessages as fit, from the front, and returns how many that was
+    int push(std::span<const MessageType> newMessages) noexcept
+    {
+        const auto region = positions.prepareWrite(static_cast<int>(newMessages.size()));
+
+        std::copy_n(newMessages.begin(), region.blockSize1, messages.begin() + region.startIndex1);
+        std::copy_n(newMessages.begin() + region.blockSize1, region.blockSize2, messages.begin() + region.startIndex2);
+
+        const auto numPushed = region.blockSize1 + region.blockSize2;
+        positions.finishWrite(numPushed);
+        return numPushed;
+    }
+
+    // consumer: returns false, leaving message as it was, if the queue is empty
+    bool pop(MessageType& message) noexcept
+    {
+        return pop(std::span<MessageType>(&message, 1)) == 1;
+    }
+
+    // consumer: moves the oldest messages into the front of destination, as many as are queued or fit,
+    // and returns how many that was
+    int pop(std::span<MessageType> destination) noexcept
+    {
+        const auto region = positions.prepareRead(static_cast<int>(destination.size()));
+
+        std::copy_n(messages.begin() + region.startIndex1, region.blockSize1, destination.begin());
+        std::copy_n(messages.begin() + region.startIndex2, region.blockSize2, destination.begin() + region.blockSize1);
+
+        const auto numPopped = region.blockSize1 + region.blockSize2;
+        positions.finishRead(numPopped);
+        return numPopped;
+    }
+
+private:
+    Positions positions;
+    std::vector<MessageType> messages;
+};
@@ -1,8 +1,11 @@
 /*
 A lock-free single-producer/single-consumer ring buffer. One thread (the "producer") may call
-addToFifo()/zeroFifo(); a single, possibly different, thread (the "consumer") may call
-getSizeToRead()/readFromFifo(). setSize()/reset() must not be called concurrently with either side -
-they're meant for one-time setup, e.g. during prepare().
+addToFifo()/zeroFifo()/acquireWrite()/commitWrite(); a single, possibly different, thread (the
+"consumer") may call getSizeToRead()/readFromFifo()/acquireRead()/commitRead()/waitForData().
+setSize()/reset() must not be called concurrently with either side - they're meant for one-time setup,
+e.g. during prepare(). The acquire/commit pairs hand out spans into the ring itself, saving the copy the
+other functions make, and waitForData() lets a consumer such as a disk writer sleep until there's enough
+to read rather than polling (see FifoDataSignal).
 
 JUCE-free by default. An addToFifo(const juce::AudioBuffer<SampleType>&, int) overload is compiled in
 when the IADSP_JUCE CMake module is enabled (IADSP_BUILD_JUCE_MODULE=ON), which defines the
@@ -12,15 +15,35 @@ addToFifo(const AudioBuffer&, int) overload for this library's own AudioBuffer c
 
 One slot of `totalSize` is always kept unwritten so a fully-wrapped write position can be told apart
 from an empty buffer: a Fifo of size N holds at most N - 1 items, and setSize(1) has zero usable
-capacity. This matches the juce::AbstractFifo this class used to wrap.
+capacity. This matches the juce::AbstractFifo this class used to wrap. PowerOfTwoFifo (at the bottom of
+this file) is the same Fifo without that slot: its size must be a power of two, and it counts reads and
+writes on 64-bit counters that only ever go up, masking them down to an index, so full and empty are
+told apart by the counts and the whole size is usable.
 
-writePos/readPos use explicit acquire/release, rather than this codebase's usual default-order atomics,
-because each position doubles as a synchronization point: the producer's release-store in finishWrite()
-pairs with the consumer's acquire-load, guaranteeing the samples just written are visible before the
-consumer reads them; the consumer's release-store in finishRead() pairs with the producer's acquire-load,
-guaranteeing the consumer's reads have completed before the producer reuses that slot - skipping this
-would be a genuine data race, not just a staleness issue. A thread's load of the position it alone
-writes uses relaxed ordering, since program order already makes its own prior writes visible to itself.
+The positions live in FifoPositions (or PowerOfTwoFifoPositions), which Fifo and MultiChannelFifo
+share. They use explicit acquire/release, rather than this codebase's usual default-order atomics,
+because each position doubles as a synchronization point: the producer's release-store in
+finishWrite() pairs with the consumer's acquire-load, guaranteeing the samples just written are visible
+before the consumer reads them; the consumer's release-store in finishRead() pairs with the producer's
+acquire-load, guaranteeing the consumer's reads have completed before the producer reuses that slot -
+skipping this would be a genuine data race, not just a staleness issue. A thread's load of the position
+it alone writes uses relaxed ordering, since program order already makes its own prior writes visible
+to itself.
+
+Each side also keeps a plain copy of the other side's position, and reloads the real one only when its
+copy says the ring is too full to write (producer) or too empty to read (consumer). A stale copy only
+ever makes the ring look fuller or emptier than it is, and the acquire-load that produced it still
+covers every slot it lets through, so this is safe. In steady streaming, as long as the other side keeps
+up, the reloads happen about once per lap of the ring rather than on every call. The two positions
+(each next to its side's copy) sit on separate cache lines, so the producer and consumer don't keep
+stealing a shared line from each other. getSizeToRead() and isFull() still read both positions fresh.
+
+Every addToFifo() overload that takes a buffer averages its channels down to mono. To keep the
+channels, use MultiChannelFifo (below): the same ring, but with getNumChannels() sample-aligned
+channels per slot, stored planar or interleaved, behind a single pair of positions. For several
+producer threads feeding one consumer, use MultiProducerFifo (at the bottom of this file) rather than a
+Fifo per producer. Fifo cuts writes short when it is full; for a display that only wants the latest
+samples, OverwritingFifo (also at the bottom) writes over the oldest ones instead.
 
 Fifo is neither copyable nor movable (std::atomic members), unlike the JUCE-backed version this replaces.
 */
@@ -30,17 +53,331 @@ Fifo is neither copyable nor movable (std::atomic members), unlike the JUCE-back
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <semaphore>
 #include <span>
 #include <vector>
 
 #include "AudioBuffer.hpp"
+#include "CacheLine.hpp"
 
 #ifdef IADSP_JUCE_AVAILABLE
     #include <juce_audio_basics/juce_audio_basics.h>
 #endif
 
-template<typename SampleType>
+// The read and write positions behind Fifo and MultiChannelFifo, and the arithmetic that splits a read or
+// write into at most two contiguous regions of the ring. Each position is only ever stored by one side;
+// see the top of this file for the memory ordering, and for the cached copies of the other side's.
+class FifoPositions
+{
+public:
+
+    // see IA_Utilities/CacheLine.hpp
+    static constexpr size_t cacheLineSize = IADSP::cacheLineSize;
+
+    struct Region
+    {
+        int startIndex1 = 0, blockSize1 = 0;
+        int startIndex2 = 0, blockSize2 = 0;
+    };
+
+    void setSize(int numElements) noexcept
+    {
+        totalSize = numElements;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        writePos.store(0);
+        readPos.store(0);
+        cachedReadPos = 0;
+        cachedWritePos = 0;
+    }
+
+    int size() const noexcept
+    {
+        return totalSize;
+    }
+
+    int getSizeToRead() const noexcept
+    {
+        return numReady(readPos.load(std::memory_order_acquire), writePos.load(std::memory_order_acquire));
+    }
+
+    int getFreeSpace() const noexcept
+    {
+        return totalSize - getSizeToRead() - 1;
+    }
+
+    Region prepareWrite(int numToWrite) noexcept
+    {
+        const auto ownWritePos = writePos.load(std::memory_order_relaxed);
+
+        // the cached read position can only be behind the real one, so it never overstates the free
+        // space; only go to the consumer's cache line when it says there isn't enough
+        if (totalSize - numReady(cachedReadPos, ownWritePos) - 1 < numToWrite) {
+            cachedReadPos = readPos.load(std::memory_order_acquire);
+        }
+
+        const auto otherReadPos = cachedReadPos;
+        numToWrite = std::min(numToWrite, totalSize - numReady(otherReadPos, ownWritePos) - 1);
+
+        Region region;
+        if (numToWrite <= 0) {
+            return region;
+        }
+
+        region.startIndex1 = ownWritePos;
+        region.blockSize1 = std::min(totalSize - ownWritePos, numToWrite);
+        numToWrite -= region.blockSize1;
+        region.blockSize2 = numToWrite <= 0 ? 0 : std::min(numToWrite, otherReadPos);
+        return region;
+    }
+
+    Region prepareRead(int numToRead) noexcept
+    {
+        const auto ownReadPos = readPos.load(std::memory_order_relaxed);
+
+        // likewise, the cached write position never overstates what's ready
+        if (numReady(ownReadPos, cachedWritePos) < numToRead) {
+            cachedWritePos = writePos.load(std::memory_order_acquire);
+        }
+
+        const auto otherWritePos = cachedWritePos;
+        numToRead = std::min(numToRead, numReady(ownReadPos, otherWritePos));
+
+        Region region;
+        if (numToRead <= 0) {
+            return region;
+        }
+
+        region.startIndex1 = ownReadPos;
+        region.blockSize1 = std::min(totalSize - ownReadPos, numToRead);
+        numToRead -= region.blockSize1;
+        region.blockSize2 = numToRead <= 0 ? 0 : std::min(numToRead, otherWritePos);
+        return region;
+    }
+
+    void finishWrite(int numWritten) noexcept
+    {
+        assert(numWritten >= 0 && numWritten < totalSize);
+        auto newPos = writePos.load(std::memory_order_relaxed) + numWritten;
+        if (newPos >= totalSize) {
+            newPos -= totalSize;
+        }
+        writePos.store(newPos, std::memory_order_release);
+    }
+
+    void finishRead(int numRead) noexcept
+    {
+        assert(numRead >= 0 && numRead < totalSize);
+        auto newPos = readPos.load(std::memory_order_relaxed) + numRead;
+        if (newPos >= totalSize) {
+            newPos -= totalSize;
+        }
+        readPos.store(newPos, std::memory_order_release);
+    }
+
+private:
+
+    // Circular forward distance from `from` to `to` - how many items are queued when `from` is the
+    // read position and `to` is the write position. Pure arithmetic; callers supply already-loaded
+    // snapshots so each can choose the right memory order for its own vs. the other thread's position.
+    int numReady(int from, int to) const noexcept
+    {
+        return to >= from ? (to - from) : (totalSize - from + to);
+    }
+
+    // Each side's position shares a cache line only with that side's copy of the other's position, so
+    // neither side's stores invalidate a line the other is reading, and totalSize (written only in
+    // setup) gets a line of its own for the same reason.
+    alignas(cacheLineSize) std::atomic<int> writePos {0};
+    int cachedReadPos = 0;
+
+    alignas(cacheLineSize) std::atomic<int> readPos {0};
+    int cachedWritePos = 0;
+
+    alignas(cacheLineSize) int totalSize = 1;
+};
+
+// The same interface as FifoPositions, for power-of-two sizes: the positions are 64-bit counts of
+// everything ever written and read, which never wrap in practice, and are masked down to an index only
+// when a region is handed out. The number of items ready is then a plain subtraction, finishing a
+// read or write a plain add, and a full ring (write count = read count + size) can't be mistaken for
+// an empty one, so all size() slots are usable. It has the same cached copies and cache-line layout.
+class PowerOfTwoFifoPositions
+{
+public:
+
+    using Region = FifoPositions::Region;
+
+    // numElements must be a power of two
+    void setSize(int numElements) noexcept
+    {
+        assert(numElements > 0 && (numElements & (numElements - 1)) == 0);
+
+        totalSize = numElements;
+        mask = static_cast<uint64_t>(numElements) - 1;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        writeCount.store(0);
+        readCount.store(0);
+        cachedReadCount = 0;
+        cachedWriteCount = 0;
+    }
+
+    int size() const noexcept
+    {
+        return totalSize;
+    }
+
+    int getSizeToRead() const noexcept
+    {
+        // read first: it can only have moved on by the time the write count is loaded, never back
+        const auto read = readCount.load(std::memory_order_acquire);
+        const auto written = writeCount.load(std::memory_order_acquire);
+        return static_cast<int>(std::min(written - read, static_cast<uint64_t>(totalSize)));
+    }
+
+    int getFreeSpace() const noexcept
+    {
+        return totalSize - getSizeToRead();
+    }
+
+    Region prepareWrite(int numToWrite) noexcept
+    {
+        const auto ownWriteCount = writeCount.load(std::memory_order_relaxed);
+
+        if (totalSize - static_cast<int>(ownWriteCount - cachedReadCount) < numToWrite) {
+            cachedReadCount = readCount.load(std::memory_order_acquire);
+        }
+
+        numToWrite = std::min(numToWrite, totalSize - static_cast<int>(ownWriteCount - cachedReadCount));
+        return makeRegion(ownWriteCount, numToWrite);
+    }
+
+    Region prepareRead(int numToRead) noexcept
+    {
+        const auto ownReadCount = readCount.load(std::memory_order_relaxed);
+
+        if (static_cast<int>(cachedWriteCount - ownReadCount) < numToRead) {
+            cachedWriteCount = writeCount.load(std::memory_order_acquire);
+        }
+
+        numToRead = std::min(numToRead, static_cast<int>(cachedWriteCount - ownReadCount));
+        return makeRegion(ownReadCount, numToRead);
+    }
+
+    void finishWrite(int numWritten) noexcept
+    {
+        assert(numWritten >= 0 && numWritten <= totalSize);
+        writeCount.store(writeCount.load(std::memory_order_relaxed) + static_cast<uint64_t>(numWritten), std::memory_order_release);
+    }
+
+    void finishRead(int numRead) noexcept
+    {
+        assert(numRead >= 0 && numRead <= totalSize);
+        readCount.store(readCount.load(std::memory_order_relaxed) + static_cast<uint64_t>(numRead), std::memory_order_release);
+    }
+
+private:
+
+    // numItems from count onwards, split where the ring wraps
+    Region makeRegion(uint64_t count, int numItems) const noexcept
+    {
+        Region region;
+        if (numItems <= 0) {
+            return region;
+        }
+
+        region.startIndex1 = static_cast<int>(count & mask);
+        region.blockSize1 = std::min(totalSize - region.startIndex1, numItems);
+        region.blockSize2 = numItems - region.blockSize1;
+        return region;
+    }
+
+    alignas(FifoPositions::cacheLineSize) std::atomic<uint64_t> writeCount {0};
+    uint64_t cachedReadCount = 0;
+
+    alignas(FifoPositions::cacheLineSize) std::atomic<uint64_t> readCount {0};
+    uint64_t cachedWriteCount = 0;
+
+    alignas(FifoPositions::cacheLineSize) int totalSize = 1;
+    uint64_t mask = 0;
+};
+
+// Lets a consumer sleep until a Fifo has data, instead of polling it on a timer. The producer's side,
+// notify(), runs after every write: a fence and a relaxed load of the waiter flag, and a semaphore
+// release (a futex or WaitOnAddress wake) only when a consumer is actually asleep. std::atomic::wait()
+// has no timed form, so the sleeping is done on a std::binary_semaphore, which does. The consumer raises
+// the flag, then re-checks for data; the producer publishes, then checks the flag; the seq_cst fences on
+// both sides make sure at least one of them sees the other, so a wakeup can't be lost.
+class FifoDataSignal
+{
+public:
+
+    void reset() noexcept
+    {
+        waiting.store(false);
+    }
+
+    void notify() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) && waiting.exchange(false, std::memory_order_acq_rel)) {
+            signal.release();
+        }
+    }
+
+    // returns isReady() once it is true, or its final value once the deadline has passed
+    template<typename ReadyFunction, typename Clock, typename Duration>
+    bool waitUntil(ReadyFunction&& isReady, std::chrono::time_point<Clock, Duration> deadline)
+    {
+        for (;;)
+        {
+            if (isReady()) {
+                return true;
+            }
+
+            waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (isReady())
+            {
+                cancelWait();
+                return true;
+            }
+
+            if (! signal.try_acquire_until(deadline))
+            {
+                cancelWait();
+                return isReady();
+            }
+        }
+    }
+
+private:
+
+    // if a producer has already taken the flag down, its release is on the way and has to be consumed
+    // here, so the semaphore is back at zero for the next wait
+    void cancelWait() noexcept
+    {
+        if (! waiting.exchange(false, std::memory_order_acq_rel)) {
+            signal.acquire();
+        }
+    }
+
+    std::atomic<bool> waiting {false};
+    std::binary_semaphore signal {0};
+};
+
+template<typename SampleType, typename Positions = FifoPositions>
 class Fifo
 {
 public:
@@ -56,7 +393,7 @@ public:
     {
         assert(numElements > 0);
 
-        totalSize = numElements;
+        positions.setSize(numElements);
         internalBuffer.resize(numElements);
         reset();
     }
@@ -64,23 +401,31 @@ public:
     void reset()
     {
         std::fill(internalBuffer.begin(), internalBuffer.end(), static_cast<SampleType>(0.0));
-        writePos.store(0);
-        readPos.store(0);
+        positions.reset();
+        dataSignal.reset();
     }
 
     int size() const noexcept
     {
-        return totalSize;
+        return positions.size();
     }
 
     int getSizeToRead() const noexcept
     {
-        return numReady(readPos.load(std::memory_order_acquire), writePos.load(std::memory_order_acquire));
+        return positions.getSizeToRead();
     }
 
     bool isFull() const noexcept
     {
-        return getFreeSpace() == 0;
+        return positions.getFreeSpace() == 0;
+    }
+
+    // Consumer only: sleeps until at least minItems are ready to read, or the timeout passes, and returns
+    // whether they are. Producers pay almost nothing for this unless the consumer is actually waiting.
+    template<typename Rep, typename Period>
+    bool waitForData(int minItems, std::chrono::duration<Rep, Period> timeout)
+    {
+        return dataSignal.waitUntil([&] { return getSizeToRead() >= minItems; }, std::chrono::steady_clock::now() + timeout);
     }
 
 #ifdef IADSP_JUCE_AVAILABLE
@@ -93,7 +438,7 @@ public:
 
         assert(numChannelsToRead > 0);
 
-        const auto region = prepareWrite(numSamples);
+        const auto region = positions.prepareWrite(numSamples);
 
         if (region.blockSize1 > 0)
         {
@@ -125,7 +470,8 @@ public:
             }
         }
 
-        finishWrite(region.blockSize1 + region.blockSize2);
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
     }
 #endif
 
@@ -138,7 +484,7 @@ public:
 
         assert(numChannelsToRead > 0);
 
-        const auto region = prepareWrite(numSamples);
+        const auto region = positions.prepareWrite(numSamples);
 
         if (region.blockSize1 > 0)
         {
@@ -170,12 +516,13 @@ public:
             }
         }
 
-        finishWrite(region.blockSize1 + region.blockSize2);
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
     }
 
     void zeroFifo(int numItems) noexcept
     {
-        const auto region = prepareWrite(numItems);
+        const auto region = positions.prepareWrite(numItems);
 
         if (region.blockSize1 > 0) {
             std::fill(internalBuffer.begin() + region.startIndex1, internalBuffer.begin() + region.startIndex1 + region.blockSize1, static_cast<SampleType>(0.0));
@@ -185,13 +532,14 @@ public:
             std::fill(internalBuffer.begin() + region.startIndex2, internalBuffer.begin() + region.startIndex2 + region.blockSize2, static_cast<SampleType>(0.0));
         }
 
-        finishWrite(region.blockSize1 + region.blockSize2);
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
     }
 
     void addToFifo(std::span<const SampleType> data) noexcept
     {
         const auto numItems = static_cast<int>(data.size());
-        const auto region = prepareWrite(numItems);
+        const auto region = positions.prepareWrite(numItems);
 
         if (region.blockSize1 > 0) {
             std::ranges::copy(data.first(static_cast<size_t>(region.blockSize1)), internalBuffer.begin() + region.startIndex1);
@@ -201,7 +549,8 @@ public:
             std::ranges::copy(data.subspan(static_cast<size_t>(region.blockSize1), static_cast<size_t>(region.blockSize2)), internalBuffer.begin() + region.startIndex2);
         }
 
-        finishWrite(region.blockSize1 + region.blockSize2);
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
     }
 
     void addToFifo(const SampleType* someData, int numItems) noexcept
@@ -212,7 +561,7 @@ public:
     void readFromFifo(std::span<SampleType> data) noexcept
     {
         const auto numItems = static_cast<int>(data.size());
-        const auto region = prepareRead(numItems);
+        const auto region = positions.prepareRead(numItems);
 
         if (region.blockSize1 > 0) {
             std::ranges::copy(internalBuffer.begin() + region.startIndex1, internalBuffer.begin() + region.startIndex1 + region.blockSize1, data.begin());
@@ -222,7 +571,7 @@ public:
             std::ranges::copy(internalBuffer.begin() + region.startIndex2, internalBuffer.begin() + region.startIndex2 + region.blockSize2, data.begin() + region.blockSize1);
         }
 
-        finishRead(region.blockSize1 + region.blockSize2);
+        positions.finishRead(region.blockSize1 + region.blockSize2);
     }
 
     void readFromFifo(SampleType* someData, int numItems) noexcept
@@ -230,87 +579,729 @@ public:
         readFromFifo(std::span<SampleType>(someData, static_cast<size_t>(numItems)));
     }
 
-private:
-
-    struct Region
+    // Up to two spans straight into the ring, in order: `second` is only non-empty when the region wraps
+    // round to the start.
+    template<typename ElementType>
+    struct Regions
     {
-        int startIndex1 = 0, blockSize1 = 0;
-        int startIndex2 = 0, blockSize2 = 0;
+        std::span<ElementType> first, second;
+
+        size_t size() const noexcept
+        {
+            return first.size() + second.size();
+        }
     };
 
-    // Circular forward distance from `from` to `to` - how many items are queued when `from` is the
-    // read position and `to` is the write position. Pure arithmetic; callers supply already-loaded
-    // snapshots so each can choose the right memory order for its own vs. the other thread's position.
-    int numReady(int from, int to) const noexcept
+    // Zero-copy access, for producers that render straight into the ring and consumers that process
+    // straight out of it. acquireWrite(n) returns room for up to n items (less if the Fifo is fuller);
+    // fill some or all of it, then commitWrite() how many were filled, which publishes them exactly like
+    // addToFifo(). acquireRead(n) returns up to n ready items; commitRead() how many were used, which
+    // frees their slots. The spans are only valid until the matching commit, and each side may have only
+    // one acquired region at a time (acquiring again before committing returns the same slots). The
+    // producer calls the write pair and the consumer the read pair, as with the copying functions.
+    Regions<SampleType> acquireWrite(int numItems) noexcept
     {
-        return to >= from ? (to - from) : (totalSize - from + to);
+        const auto region = positions.prepareWrite(numItems);
+        return { spanAt(region.startIndex1, region.blockSize1), spanAt(region.startIndex2, region.blockSize2) };
     }
 
-    int getFreeSpace() const noexcept
+    void commitWrite(int numItems) noexcept
     {
-        return totalSize - getSizeToRead() - 1;
+        positions.finishWrite(numItems);
+        dataSignal.notify();
     }
 
-    Region prepareWrite(int numToWrite) noexcept
+    Regions<const SampleType> acquireRead(int numItems) noexcept
     {
-        const auto ownWritePos = writePos.load(std::memory_order_relaxed);
-        const auto otherReadPos = readPos.load(std::memory_order_acquire);
+        const auto region = positions.prepareRead(numItems);
+        return { spanAt(region.startIndex1, region.blockSize1), spanAt(region.startIndex2, region.blockSize2) };
+    }
 
-        numToWrite = std::min(numToWrite, totalSize - numReady(otherReadPos, ownWritePos) - 1);
+    void commitRead(int numItems) noexcept
+    {
+        positions.finishRead(numItems);
+    }
 
-        Region region;
-        if (numToWrite <= 0) {
-            return region;
-        }
+private:
 
-        region.startIndex1 = ownWritePos;
-        region.blockSize1 = std::min(totalSize - ownWritePos, numToWrite);
-        numToWrite -= region.blockSize1;
-        region.blockSize2 = numToWrite <= 0 ? 0 : std::min(numToWrite, otherReadPos);
-        return region;
+    std::span<SampleType> spanAt(int startIndex, int numItems) noexcept
+    {
+        return { internalBuffer.data() + startIndex, static_cast<size_t>(numItems) };
     }
 
-    Region prepareRead(int numToRead) noexcept
-    {
-        const auto ownReadPos = readPos.load(std::memory_order_relaxed);
-        const auto otherWritePos = writePos.load(std::memory_order_acquire);
+    Positions positions;
+    FifoDataSignal dataSignal;
+    std::vector<SampleType> internalBuffer;
+};
 
-        numToRead = std::min(numToRead, numReady(ownReadPos, otherWritePos));
+// How MultiChannelFifo stores its channels: one contiguous ring per channel, or frame by frame.
+enum struct FifoLayout
+{
+    Planar,
+    Interleaved
+};
 
-        Region region;
-        if (numToRead <= 0) {
-            return region;
+// A Fifo for several sample-aligned channels that share one read and one write position, so a whole
+// multichannel block is committed with a single release-store instead of one per channel, and the
+// channels can never drift apart. Channels are kept as they are - nothing is downmixed. Pick the layout
+// that matches the side doing most of the copying: Planar suits AudioBuffer / per-channel analysers
+// (each channel's region is a plain copy), Interleaved suits writing straight to an interleaved file
+// or device buffer (addInterleavedToFifo()/readInterleavedFromFifo() become a single copy). Either
+// layout accepts either form of input and output. As with Fifo, writes beyond the free space are
+// dropped, reads beyond what's ready are cut short, one frame is kept unwritten, and setSize()/reset()
+// are for setup only.
+template<typename SampleType, typename Positions = FifoPositions>
+class MultiChannelFifo
+{
+public:
+
+    MultiChannelFifo() {}
+
+    MultiChannelFifo(int numChannels, int numFrames, FifoLayout layout = FifoLayout::Planar)
+    {
+        setSize(numChannels, numFrames, layout);
+    }
+
+    void setSize(int newNumChannels, int numFrames, FifoLayout newLayout = FifoLayout::Planar)
+    {
+        assert(newNumChannels > 0 && numFrames > 0);
+
+        numChannels = newNumChannels;
+        layout = newLayout;
+        positions.setSize(numFrames);
+        internalBuffer.resize(static_cast<size_t>(numChannels) * static_cast<size_t>(numFrames));
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(internalBuffer.begin(), internalBuffer.end(), static_cast<SampleType>(0.0));
+        positions.reset();
+        dataSignal.reset();
+    }
+
+    // in frames
+    int size() const noexcept
+    {
+        return positions.size();
+    }
+
+    int getNumChannels() const noexcept
+    {
+        return numChannels;
+    }
+
+    FifoLayout getLayout() const noexcept
+    {
+        return layout;
+    }
+
+    int getSizeToRead() const noexcept
+    {
+        return positions.getSizeToRead();
+    }
+
+    bool isFull() const noexcept
+    {
+        return positions.getFreeSpace() == 0;
+    }
+
+    // Consumer only: sleeps until at least minItems are ready to read, or the timeout passes, and returns
+    // whether they are. Producers pay almost nothing for this unless the consumer is actually waiting.
+    template<typename Rep, typename Period>
+    bool waitForData(int minItems, std::chrono::duration<Rep, Period> timeout)
+    {
+        return dataSignal.waitUntil([&] { return getSizeToRead() >= minItems; }, std::chrono::steady_clock::now() + timeout);
+    }
+
+    // channels the source doesn't have are written as silence, and source channels beyond
+    // getNumChannels() are ignored
+    void addToFifo(const SampleType* const* channelData, int numSourceChannels, int numFrames) noexcept
+    {
+        const auto region = positions.prepareWrite(numFrames);
+
+        forEachSegment(region, [&](int start, int offset, int count)
+        {
+            for(int c = 0; c < numChannels; ++c)
+            {
+                const auto* source = c < numSourceChannels ? channelData[c] + offset : nullptr;
+
+                if(layout == FifoLayout::Planar)
+                {
+                    auto* destination = internalBuffer.data() + channelStart(c) + start;
+                    if(source != nullptr) {
+                        std::copy(source, source + count, destination);
+                    }
+                    else {
+                        std::fill(destination, destination + count, static_cast<SampleType>(0.0));
+                    }
+                }
+                else
+                {
+                    auto* destination = internalBuffer.data() + static_cast<size_t>(start) * numChannels + c;
+                    for(int i = 0; i < count; ++i) {
+                        destination[static_cast<size_t>(i) * numChannels] = source != nullptr ? source[i] : static_cast<SampleType>(0.0);
+                    }
+                }
+            }
+        });
+
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
+    }
+
+    void addToFifo(const AudioBuffer<SampleType>& buffer) noexcept
+    {
+        addToFifo(buffer.data(), static_cast<int>(buffer.numChannels()), static_cast<int>(buffer.numFrames()));
+    }
+
+#ifdef IADSP_JUCE_AVAILABLE
+    void addToFifo(const juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        addToFifo(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+    }
+#endif
+
+    // numFrames frames of getNumChannels() interleaved samples each
+    void addInterleavedToFifo(const SampleType* interleaved, int numFrames) noexcept
+    {
+        const auto region = positions.prepareWrite(numFrames);
+
+        forEachSegment(region, [&](int start, int offset, int count)
+        {
+            const auto* source = interleaved + static_cast<size_t>(offset) * numChannels;
+
+            if(layout == FifoLayout::Interleaved) {
+                std::copy(source, source + static_cast<size_t>(count) * numChannels, internalBuffer.data() + static_cast<size_t>(start) * numChannels);
+            }
+            else
+            {
+                for(int c = 0; c < numChannels; ++c)
+                {
+                    auto* destination = internalBuffer.data() + channelStart(c) + start;
+                    for(int i = 0; i < count; ++i) {
+                        destination[i] = source[static_cast<size_t>(i) * numChannels + c];
+                    }
+                }
+            }
+        });
+
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
+    }
+
+    void zeroFifo(int numFrames) noexcept
+    {
+        const auto region = positions.prepareWrite(numFrames);
+
+        forEachSegment(region, [&](int start, int, int count)
+        {
+            if(layout == FifoLayout::Interleaved)
+            {
+                auto* destination = internalBuffer.data() + static_cast<size_t>(start) * numChannels;
+                std::fill(destination, destination + static_cast<size_t>(count) * numChannels, static_cast<SampleType>(0.0));
+            }
+            else
+            {
+                for(int c = 0; c < numChannels; ++c)
+                {
+                    auto* destination = internalBuffer.data() + channelStart(c) + start;
+                    std::fill(destination, destination + count, static_cast<SampleType>(0.0));
+                }
+            }
+        });
+
+        positions.finishWrite(region.blockSize1 + region.blockSize2);
+        dataSignal.notify();
+    }
+
+    // destination channels beyond getNumChannels() are left untouched, and channels the destination
+    // doesn't have are discarded
+    void readFromFifo(SampleType* const* channelData, int numDestinationChannels, int numFrames) noexcept
+    {
+        const auto region = positions.prepareRead(numFrames);
+        const auto numToCopy = std::min(numChannels, numDestinationChannels);
+
+        forEachSegment(region, [&](int start, int offset, int count)
+        {
+            for(int c = 0; c < numToCopy; ++c)
+            {
+                auto* destination = channelData[c] + offset;
+
+                if(layout == FifoLayout::Planar)
+                {
+                    const auto* source = internalBuffer.data() + channelStart(c) + start;
+                    std::copy(source, source + count, destination);
+                }
+                else
+                {
+                    const auto* source = internalBuffer.data() + static_cast<size_t>(start) * numChannels + c;
+                    for(int i = 0; i < count; ++i) {
+                        destination[i] = source[static_cast<size_t>(i) * numChannels];
+                    }
+                }
+            }
+        });
+
+        positions.finishRead(region.blockSize1 + region.blockSize2);
+    }
+
+    void readFromFifo(AudioBuffer<SampleType>& buffer) noexcept
+    {
+        readFromFifo(buffer.data(), static_cast<int>(buffer.numChannels()), static_cast<int>(buffer.numFrames()));
+    }
+
+    void readInterleavedFromFifo(SampleType* interleaved, int numFrames) noexcept
+    {
+        const auto region = positions.prepareRead(numFrames);
+
+        forEachSegment(region, [&](int start, int offset, int count)
+        {
+            auto* destination = interleaved + static_cast<size_t>(offset) * numChannels;
+
+            if(layout == FifoLayout::Interleaved)
+            {
+                const auto* source = internalBuffer.data() + static_cast<size_t>(start) * numChannels;
+                std::copy(source, source + static_cast<size_t>(count) * numChannels, destination);
+            }
+            else
+            {
+                for(int c = 0; c < numChannels; ++c)
+                {
+                    const auto* source = internalBuffer.data() + channelStart(c) + start;
+                    for(int i = 0; i < count; ++i) {
+                        destination[static_cast<size_t>(i) * numChannels + c] = source[i];
+                    }
+                }
+            }
+        });
+
+        positions.finishRead(region.blockSize1 + region.blockSize2);
+    }
+
+private:
+
+    // calls function(ring index, offset into the caller's block, frame count) for each non-empty part
+    // of the region
+    template<typename Function>
+    static void forEachSegment(const typename Positions::Region& region, Function&& function)
+    {
+        if (region.blockSize1 > 0) {
+            function(region.startIndex1, 0, region.blockSize1);
         }
 
-        region.startIndex1 = ownReadPos;
-        region.blockSize1 = std::min(totalSize - ownReadPos, numToRead);
-        numToRead -= region.blockSize1;
-        region.blockSize2 = numToRead <= 0 ? 0 : std::min(numToRead, otherWritePos);
-        return region;
+        if (region.blockSize2 > 0) {
+            function(region.startIndex2, region.blockSize1, region.blockSize2);
+        }
     }
 
-    void finishWrite(int numWritten) noexcept
+    size_t channelStart(int channel) const noexcept
     {
-        assert(numWritten >= 0 && numWritten < totalSize);
-        auto newPos = writePos.load(std::memory_order_relaxed) + numWritten;
-        if (newPos >= totalSize) {
-            newPos -= totalSize;
+        return static_cast<size_t>(channel) * static_cast<size_t>(positions.size());
+    }
+
+    Positions positions;
+    FifoDataSignal dataSignal;
+    std::vector<SampleType> internalBuffer;
+    int numChannels = 1;
+    FifoLayout layout = FifoLayout::Planar;
+};
+
+// Fifo and MultiChannelFifo for power-of-two sizes (see PowerOfTwoFifoPositions): setSize(N) holds all N
+// items, and working out a region involves no wrap-around compares.
+template<typename SampleType>
+using PowerOfTwoFifo = Fifo<SampleType, PowerOfTwoFifoPositions>;
+
+template<typename SampleType>
+using PowerOfTwoMultiChannelFifo = MultiChannelFifo<SampleType, PowerOfTwoFifoPositions>;
+
+// A lock-free multi-producer/single-consumer Fifo, for several audio threads (plugin instances on a
+// multithreaded graph, or busses rendered in parallel) feeding one analyser or recorder through a single
+// queue. Any number of threads may call addToFifo()/zeroFifo() at once; one consumer thread calls
+// getSizeToRead()/readFromFifo(). The size must be a power of two, and all of it is usable.
+//
+// A producer reserves a contiguous block of the ring by advancing a shared 64-bit reservation count with
+// compare-and-swap (a fetch-add couldn't be taken back when the ring turns out to be full), copies its
+// samples in, and then publishes the block by storing the count its block ends at into a marker kept for
+// the block's first slot. The consumer follows those markers from where it is, block by block, so it only
+// ever sees whole blocks, in the order they were reserved, and a block published early waits for the
+// ones reserved before it. Producers never wait on each other: a producer that stalls between reserving
+// and publishing only holds back what the consumer can see, and everyone else carries on writing until
+// the ring is full. A marker left over from an earlier lap always holds a count at or before the slot's
+// current position, so it can't be mistaken for a new block and the markers never need clearing.
+//
+// The markers cost one 64-bit atomic per slot. Like Fifo, writes that don't fit are cut short (each
+// producer's block is all-or-part, never interleaved with another's), and setSize()/reset() are for setup
+// only.
+template<typename SampleType>
+class MultiProducerFifo
+{
+public:
+
+    MultiProducerFifo() {}
+
+    MultiProducerFifo(int size)
+    {
+        setSize(size);
+    }
+
+    // numElements must be a power of two
+    void setSize(int numElements)
+    {
+        assert(numElements > 0 && (numElements & (numElements - 1)) == 0);
+
+        totalSize = numElements;
+        mask = static_cast<uint64_t>(numElements) - 1;
+        internalBuffer.resize(static_cast<size_t>(numElements));
+        blockEnds = std::vector<std::atomic<uint64_t>>(static_cast<size_t>(numElements));
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(internalBuffer.begin(), internalBuffer.end(), static_cast<SampleType>(0.0));
+        for(auto& end : blockEnds) {
+            end.store(0);
         }
-        writePos.store(newPos, std::memory_order_release);
+
+        reservedCount.store(0);
+        readCount.store(0);
+        publishedCount = 0;
     }
 
-    void finishRead(int numRead) noexcept
+    int size() const noexcept
     {
-        assert(numRead >= 0 && numRead < totalSize);
-        auto newPos = readPos.load(std::memory_order_relaxed) + numRead;
-        if (newPos >= totalSize) {
-            newPos -= totalSize;
+        return totalSize;
+    }
+
+    // consumer only: how many samples have been published and not yet read
+    int getSizeToRead() noexcept
+    {
+        collectPublished();
+        return static_cast<int>(publishedCount - readCount.load(std::memory_order_relaxed));
+    }
+
+    void addToFifo(std::span<const SampleType> data) noexcept
+    {
+        write(static_cast<int>(data.size()), [&](SampleType* destination, int offset, int count)
+        {
+            std::copy(data.begin() + offset, data.begin() + offset + count, destination);
+        });
+    }
+
+    void addToFifo(const SampleType* someData, int numItems) noexcept
+    {
+        addToFifo(std::span<const SampleType>(someData, static_cast<size_t>(numItems)));
+    }
+
+    // averages the channels down to mono, like Fifo's
+    void addToFifo(const AudioBuffer<SampleType>& buffer, int numChannelsToRead = -1) noexcept
+    {
+        if(numChannelsToRead <= 0) {
+            numChannelsToRead = static_cast<int>(buffer.numChannels());
         }
-        readPos.store(newPos, std::memory_order_release);
+
+        assert(numChannelsToRead > 0);
+
+        write(static_cast<int>(buffer.numFrames()), [&](SampleType* destination, int offset, int count)
+        {
+            for(int i = 0; i < count; ++i)
+            {
+                auto value = buffer.channel(0)[offset + i];
+                if(numChannelsToRead > 1) {
+                    for(int c = 1; c < numChannelsToRead; ++c) {
+                        value += buffer.channel(static_cast<uint32_t>(c))[offset + i];
+                    }
+                    value = value / static_cast<SampleType>(numChannelsToRead);
+                }
+                destination[i] = static_cast<SampleType>(value);
+            }
+        });
+    }
+
+    void zeroFifo(int numItems) noexcept
+    {
+        write(numItems, [](SampleType* destination, int, int count)
+        {
+            std::fill(destination, destination + count, static_cast<SampleType>(0.0));
+        });
+    }
+
+    void readFromFifo(std::span<SampleType> data) noexcept
+    {
+        collectPublished();
+
+        const auto ownReadCount = readCount.load(std::memory_order_relaxed);
+        const auto numToRead = std::min(static_cast<uint64_t>(data.size()), publishedCount - ownReadCount);
+        if (numToRead == 0) {
+            return;
+        }
+
+        const auto start = static_cast<size_t>(ownReadCount & mask);
+        const auto firstPart = std::min(static_cast<size_t>(totalSize) - start, static_cast<size_t>(numToRead));
+        std::copy(internalBuffer.begin() + start, internalBuffer.begin() + start + firstPart, data.begin());
+        std::copy(internalBuffer.begin(), internalBuffer.begin() + (numToRead - firstPart), data.begin() + firstPart);
+
+        readCount.store(ownReadCount + numToRead, std::memory_order_release);
+    }
+
+    void readFromFifo(SampleType* someData, int numItems) noexcept
+    {
+        readFromFifo(std::span<SampleType>(someData, static_cast<size_t>(numItems)));
+    }
+
+private:
+
+    // reserves up to numItems slots, has fill(destination, offset into the block, count) write each
+    // contiguous part of them, then publishes the block
+    template<typename Fill>
+    void write(int numItems, Fill&& fill) noexcept
+    {
+        if (numItems <= 0) {
+            return;
+        }
+
+        auto start = reservedCount.load(std::memory_order_relaxed);
+        uint64_t numToWrite = 0;
+
+        for (;;)
+        {
+            // the acquire makes sure the consumer has finished with the slots being taken over; a start
+            // that has fallen behind the consumer is stale, and the compare-and-swap will refresh it
+            const auto read = readCount.load(std::memory_order_acquire);
+            const auto used = start > read ? start - read : 0;
+            numToWrite = std::min(static_cast<uint64_t>(numItems), static_cast<uint64_t>(totalSize) - used);
+            if (numToWrite == 0) {
+                return;
+            }
+
+            if (reservedCount.compare_exchange_weak(start, start + numToWrite, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        const auto index = static_cast<size_t>(start & mask);
+        const auto firstPart = std::min(static_cast<size_t>(totalSize) - index, static_cast<size_t>(numToWrite));
+        fill(internalBuffer.data() + index, 0, static_cast<int>(firstPart));
+        if (numToWrite > firstPart) {
+            fill(internalBuffer.data(), static_cast<int>(firstPart), static_cast<int>(numToWrite - firstPart));
+        }
+
+        blockEnds[index].store(start + numToWrite, std::memory_order_release);
+    }
+
+    // consumer side: moves publishedCount on over every block that is published and follows on from it
+    void collectPublished() noexcept
+    {
+        for (;;)
+        {
+            const auto end = blockEnds[static_cast<size_t>(publishedCount & mask)].load(std::memory_order_acquire);
+            if (end <= publishedCount) {
+                return;
+            }
+            publishedCount = end;
+        }
+    }
+
+    alignas(FifoPositions::cacheLineSize) std::atomic<uint64_t> reservedCount {0};
+    alignas(FifoPositions::cacheLineSize) std::atomic<uint64_t> readCount {0};
+    uint64_t publishedCount = 0;
+
+    alignas(FifoPositions::cacheLineSize) int totalSize = 1;
+    uint64_t mask = 0;
+    std::vector<SampleType> internalBuffer;
+    std::vector<std::atomic<uint64_t>> blockEnds;
+};
+
+// A lossy single-producer/single-consumer Fifo for visualisation, where only the latest samples matter and
+// the audio thread must never be held back by a consumer that has stalled (a GUI behind another window, or
+// a display that isn't being repainted). The producer always writes everything it is given, and once the
+// ring is full it simply carries on over the oldest samples; it never looks at the consumer's position at
+// all. The consumer notices when it has been lapped and resynchronises: readFromFifo() then skips to the
+// newest samples, as many as it was asked for, and getNumSamplesDropped() counts everything skipped. The
+// size must be a power of two, and all of it is usable.
+//
+// Since the producer doesn't wait, it can overwrite samples the consumer is copying out at that moment.
+// This is caught in the same way as a seqlock: before writing, the producer announces how far it is about
+// to write (claimedCount, then a release fence); after copying, the consumer fences and loads that count,
+// and drops any samples it copied that the announced write may have reached, so readFromFifo() only ever
+// returns samples that were intact. As in any C++ seqlock, the samples themselves are stored and loaded as
+// relaxed atomics (through std::atomic_ref, which for float and double compiles to plain moves), so an
+// overlapping copy is a race the check catches rather than undefined behaviour. Asking for much less than
+// the whole ring leaves the producer room to write while the consumer copies without anything having to
+// be dropped.
+//
+// One thread calls addToFifo()/zeroFifo(); one other calls getSizeToRead()/readFromFifo()/
+// getNumSamplesDropped(). setSize()/reset() are for setup only.
+template<typename SampleType>
+class OverwritingFifo
+{
+public:
+    static_assert(std::atomic_ref<SampleType>::is_always_lock_free, "OverwritingFifo's samples are loaded and stored atomically");
+    static_assert(std::atomic_ref<SampleType>::required_alignment == alignof(SampleType), "the ring is a plain std::vector<SampleType>");
+
+    OverwritingFifo() {}
+
+    OverwritingFifo(int size)
+    {
+        setSize(size);
+    }
+
+    // numElements must be a power of two
+    void setSize(int numElements)
+    {
+        assert(numElements > 0 && (numElements & (numElements - 1)) == 0);
+
+        totalSize = numElements;
+        mask = static_cast<uint64_t>(numElements) - 1;
+        internalBuffer.resize(static_cast<size_t>(numElements));
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(internalBuffer.begin(), internalBuffer.end(), static_cast<SampleType>(0.0));
+        claimedCount.store(0);
+        writeCount.store(0);
+        readCount = 0;
+        numSamplesDropped = 0;
+    }
+
+    int size() const noexcept
+    {
+        return totalSize;
+    }
+
+    // consumer only: how many unread samples are still in the ring, at most size()
+    int getSizeToRead() const noexcept
+    {
+        const auto written = writeCount.load(std::memory_order_acquire);
+        return static_cast<int>(std::min(written - readCount, static_cast<uint64_t>(totalSize)));
+    }
+
+    // consumer only: the total number of samples skipped or overwritten before they could be read
+    uint64_t getNumSamplesDropped() const noexcept
+    {
+        return numSamplesDropped;
+    }
+
+    void addToFifo(std::span<const SampleType> data) noexcept
+    {
+        write(static_cast<int>(data.size()), [&](int i) { return data[static_cast<size_t>(i)]; });
+    }
+
+    void addToFifo(const SampleType* someData, int numItems) noexcept
+    {
+        addToFifo(std::span<const SampleType>(someData, static_cast<size_t>(numItems)));
+    }
+
+    // averages the channels down to mono, like Fifo's
+    void addToFifo(const AudioBuffer<SampleType>& buffer, int numChannelsToRead = -1) noexcept
+    {
+        if(numChannelsToRead <= 0) {
+            numChannelsToRead = static_cast<int>(buffer.numChannels());
+        }
+
+        assert(numChannelsToRead > 0);
+
+        write(static_cast<int>(buffer.numFrames()), [&](int i)
+        {
+            auto value = buffer.channel(0)[i];
+            if(numChannelsToRead > 1) {
+                for(int c = 1; c < numChannelsToRead; ++c) {
+                    value += buffer.channel(static_cast<uint32_t>(c))[i];
+                }
+                value = value / static_cast<SampleType>(numChannelsToRead);
+            }
+            return static_cast<SampleType>(value);
+        });
     }
 
-    std::atomic<int> writePos {0};
-    std::atomic<int> readPos {0};
-    int totalSize = 1;
+    void zeroFifo(int numItems) noexcept
+    {
+        write(numItems, [](int) { return static_cast<SampleType>(0.0); });
+    }
+
+    // Reads the oldest unread samples, or, if the producer has lapped the consumer since the last read,
+    // the newest data.size() of them. Returns how many were read into the start of data, which can be
+    // fewer than were asked for if some were overwritten while being copied.
+    int readFromFifo(std::span<SampleType> data) noexcept
+    {
+        const auto written = writeCount.load(std::memory_order_acquire);
+        const auto wanted = std::min(static_cast<uint64_t>(data.size()), static_cast<uint64_t>(totalSize));
+        auto start = readCount;
+
+        if (written - start > static_cast<uint64_t>(totalSize))
+        {
+            numSamplesDropped += written - wanted - start;
+            start = written - wanted;
+        }
+
+        const auto numToRead = std::min(wanted, written - start);
+        if (numToRead == 0) {
+            readCount = start;
+            return 0;
+        }
+
+        // relaxed atomic loads rather than a plain copy: the producer may be storing to these very slots
+        for(uint64_t i = 0; i < numToRead; ++i) {
+            data[static_cast<size_t>(i)] = std::atomic_ref<SampleType>(internalBuffer[static_cast<size_t>((start + i) & mask)]).load(std::memory_order_relaxed);
+        }
+
+        // every slot before claimed - totalSize may have been written over while it was being copied
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto claimed = claimedCount.load(std::memory_order_relaxed);
+        const auto firstIntact = claimed > static_cast<uint64_t>(totalSize) ? claimed - static_cast<uint64_t>(totalSize) : 0;
+        const auto numOverwritten = firstIntact > start ? std::min(firstIntact - start, numToRead) : 0;
+
+        if (numOverwritten > 0)
+        {
+            std::copy(data.begin() + numOverwritten, data.begin() + numToRead, data.begin());
+            numSamplesDropped += numOverwritten;
+        }
+
+        readCount = start + numToRead;
+        return static_cast<int>(numToRead - numOverwritten);
+    }
+
+    int readFromFifo(SampleType* someData, int numItems) noexcept
+    {
+        return readFromFifo(std::span<SampleType>(someData, static_cast<size_t>(numItems)));
+    }
+
+private:
+
+    // stores sampleAt(i) for each of the newest min(numItems, totalSize) items i, after announcing the
+    // write to the consumer
+    template<typename SampleFunction>
+    void write(int numItems, SampleFunction&& sampleAt) noexcept
+    {
+        if (numItems <= 0) {
+            return;
+        }
+
+        const auto start = writeCount.load(std::memory_order_relaxed);
+        const auto end = start + static_cast<uint64_t>(numItems);
+        const auto skipped = std::max(0, numItems - totalSize);
+
+        claimedCount.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // relaxed atomic stores, as the consumer may be loading from these slots (see readFromFifo())
+        for(int i = skipped; i < numItems; ++i) {
+            std::atomic_ref<SampleType>(internalBuffer[static_cast<size_t>((start + static_cast<uint64_t>(i)) & mask)]).store(sampleAt(i), std::memory_order_relaxed);
+        }
+
+        writeCount.store(end, std::memory_order_release);
+    }
+
+    alignas(FifoPositions::cacheLineSize) std::atomic<uint64_t> claimedCount {0};
+    std::atomic<uint64_t> writeCount {0};
+
+    alignas(FifoPositions::cacheLineSize) uint64_t readCount = 0;
+    uint64_t numSamplesDropped = 0;
+
+    alignas(FifoPositions::cacheLineSize) int totalSize = 1;
+    uint64_t mask = 0;
     std::vector<SampleType> internalBuffer;
 };
@@ -1,4 +1,5 @@
 #include "LoudnessMeter.hpp"
+#include <cstring>
 
 namespace IADSP
 {
@@ -75,6 +76,8 @@ namespace IADSP
         {
             useUnfilledAccumulators = true;
         }
+
+        publishSnapshot(ZERO);
     }
 
     template<typename Type>
@@ -95,7 +98,7 @@ namespace IADSP
     void LoudnessMeter<Type>::processBuffer(const Type* const* inputBlock, int numSamples)
     {
 
-        auto magnitude = ZERO;
+        auto magnitude = ZERO, peak = ZERO;
         for (int c = 0; c < numChannels; ++c)
         {
             std::memcpy(internalBuffer[c].data(), inputBlock[c], numSamples * sizeof(Type));
@@ -106,11 +109,13 @@ namespace IADSP
                     return std::abs(x) < std::abs(y);
                 });
             magnitude = std::max(magnitude, *maxValue);
+            peak = std::max(peak, std::abs(*maxValue));
         }
 
         applyWeighting(numSamples);
 
         if(pauseOnSilence && magnitude <= SILENCE_THRESHOLD) {
+            publishSnapshot(peak);
             return;
         }
 
@@ -157,6 +162,8 @@ namespace IADSP
                 }
             }
         }
+
+        publishSnapshot(peak);
     }
     
     template<typename Type>
@@ -172,10 +179,12 @@ namespace IADSP
                 return std::abs(x) < std::abs(y);
             });
         magnitude = std::max(magnitude, *maxValue);
+        const auto peak = std::abs(*maxValue);
 
         applyWeighting(numSamples);
 
         if(pauseOnSilence && magnitude <= SILENCE_THRESHOLD) {
+            publishSnapshot(peak);
             return;
         }
 
@@ -207,6 +216,8 @@ namespace IADSP
                 }
             }
         }
+
+        publishSnapshot(peak);
     }
 
     template<typename Type>
@@ -216,6 +227,12 @@ namespace IADSP
         return smoothedVal;
     }
 
+    template<typename Type>
+    void LoudnessMeter<Type>::publishSnapshot(Type peak) noexcept
+    {
+        snapshots.publish({ lastValue, peak });
+    }
+
     template<typename Type>
     void LoudnessMeter<Type>::applyWeighting(int numSamplesToProcess)
     {
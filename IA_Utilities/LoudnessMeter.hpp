@@ -5,6 +5,7 @@
 #include <cmath>
 #include "../IA_Filters/FirstOrderFilter.hpp"
 #include "../IA_Filters/EQ/OnePoleEQFilter.hpp"
+#include "SnapshotPublisher.hpp"
 
 /*
 
@@ -14,6 +15,10 @@ Short-term = 3s
 
 Refresh rate of at least 10Hz
 
+getLoudness() and getSmoothedLoudness() belong to the thread calling processBuffer(). Other threads
+(a GUI timer) should use getSnapshot() instead, which returns the values published at the end of the
+latest processBuffer() call through a SnapshotPublisher, without tearing.
+
 */
 
 namespace IADSP
@@ -22,6 +27,14 @@ namespace IADSP
     class LoudnessMeter
     {
     public:
+        // what processBuffer() publishes for other threads once per call
+        struct Snapshot
+        {
+            Type loudness = static_cast<Type>(0.0);
+            // the highest absolute sample value of the block, before weighting
+            Type peak = static_cast<Type>(0.0);
+        };
+
         LoudnessMeter();
 
         void setSampleRate(double newSampleRate);
@@ -35,6 +48,9 @@ namespace IADSP
         Type getLoudness() { return lastValue; }
         Type getSmoothedLoudness();
 
+        // may be called from one thread other than the processing one
+        Snapshot getSnapshot() noexcept { return snapshots.read(); }
+
         void setWindowSize(double sizeInSeconds);
         void setUpdateRate(double timeInSeconds);
         void setPauseOnSilence(bool meterShouldPause) { pauseOnSilence = meterShouldPause; }
@@ -50,6 +66,7 @@ namespace IADSP
         FirstOrderFilter<Type> inputHPFilter { FirstOrderFilterMode::Highpass };
         OnePoleEQFilter<Type> inputShelfFilter { OnePoleEQFilterMode::HighPass };
         void applyWeighting(int numSamplesToProcess);
+        void publishSnapshot(Type peak) noexcept;
 
         bool pauseOnSilence = false, resetToZero = true, useUnfilledAccumulators = true;
         static constexpr Type SILENCE_THRESHOLD = static_cast<Type>(2.51e-10);
@@ -69,5 +86,7 @@ namespace IADSP
         static constexpr Type SMOOTHING_COEFF = static_cast<Type>(0.25);
         Type lastValue = 0.0f;
         Type smoothedVal = 0.0f;
+
+        SnapshotPublisher<Snapshot> snapshots;
     };
 }
\ No newline at end of file
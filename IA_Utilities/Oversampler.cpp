@@ -13,158 +13,449 @@ namespace IADSP
         return std::clamp(order, 2, 8);
     }
 
-    template<typename Type>
-    Oversampler<Type>::Oversampler()
+    // The allpass stages are given the stopband attenuation the Butterworth stage of the same depth
+    // reaches at the shared stopband edge (0.75 of Nyquist): 20 * log10(tan(3pi/8) / tan(pi/8)), about
+    // 15.3dB, per order.
+    double attenuationForStage(int stageIndex)
     {
+        return 15.3 * orderForStage(stageIndex);
     }
 
+    //===== Chain =====
+
     template<typename Type>
-    void Oversampler<Type>::setNumStages(int newNumStages)
+    void Oversampler<Type>::Chain::setMaxStages(int maxStages)
     {
-        numStages = newNumStages < 0 ? 0 : newNumStages;
-        const auto numIirStages = static_cast<size_t>(std::max(0, numStages - 1));
+        const auto numIirStages = static_cast<size_t>(std::max(0, maxStages - 1));
 
         iirUpStages.resize(numIirStages);
         iirDownStages.resize(numIirStages);
+        allpassUpStages.resize(numIirStages);
+        allpassDownStages.resize(numIirStages);
 
         for(size_t i = 0; i < numIirStages; ++i)
         {
             const auto order = orderForStage(static_cast<int>(i) + 2);
             iirUpStages[i].setOrder(order);
             iirDownStages[i].setOrder(order);
+
+            const auto attenuation = attenuationForStage(static_cast<int>(i) + 2);
+            allpassUpStages[i].setDesign(attenuation);
+            allpassDownStages[i].setDesign(attenuation);
         }
+
     }
 
     template<typename Type>
-    void Oversampler<Type>::prepare(int newNumChannels, int newMaximumBlockSize)
+    void Oversampler<Type>::Chain::setNumChannels(int newNumChannels)
     {
-        numChannels = newNumChannels;
-        maximumBlockSize = newMaximumBlockSize;
+        std::visit([newNumChannels](auto& fir) { fir.setNumChannels(newNumChannels); }, firUp);
+        std::visit([newNumChannels](auto& fir) { fir.setNumChannels(newNumChannels); }, firDown);
 
-        const auto maxLength = static_cast<size_t>(maximumBlockSize) << numStages;
+        for(auto& stage : iirUpStages) {
+            stage.setNumChannels(newNumChannels);
+        }
+        for(auto& stage : iirDownStages) {
+            stage.setNumChannels(newNumChannels);
+        }
+        for(auto& stage : allpassUpStages) {
+            stage.setNumChannels(newNumChannels);
+        }
+        for(auto& stage : allpassDownStages) {
+            stage.setNumChannels(newNumChannels);
+        }
+    }
 
-        bufferA.assign(numChannels, std::vector<Type>(maxLength, static_cast<Type>(0.0)));
-        bufferB.assign(numChannels, std::vector<Type>(maxLength, static_cast<Type>(0.0)));
+    template<typename Type>
+    void Oversampler<Type>::Chain::reset() noexcept
+    {
+        std::visit([](auto& fir) { fir.reset(); }, firUp);
+        std::visit([](auto& fir) { fir.reset(); }, firDown);
+        resetStagesAbove(1);
+    }
 
-        bufferAPointers.resize(numChannels);
-        bufferBPointers.resize(numChannels);
-        for(int c = 0; c < numChannels; ++c) {
-            bufferAPointers[c] = bufferA[c].data();
-            bufferBPointers[c] = bufferB[c].data();
+    template<typename Type>
+    void Oversampler<Type>::Chain::resetStagesAbove(int stage) noexcept
+    {
+        // stage indices count from 1 (the FIR), so IIR stage s lives at index s - 2
+        for(size_t i = static_cast<size_t>(std::max(0, stage - 1)); i < iirUpStages.size(); ++i)
+        {
+            iirUpStages[i].reset();
+            iirDownStages[i].reset();
+            allpassUpStages[i].reset();
+            allpassDownStages[i].reset();
         }
+    }
 
-        firUp.setNumChannels(numChannels);
-        firDown.setNumChannels(numChannels);
-
+    template<typename Type>
+    void Oversampler<Type>::Chain::snapToZero() noexcept
+    {
         for(auto& stage : iirUpStages) {
-            stage.setNumChannels(numChannels);
+            stage.snapToZero();
         }
         for(auto& stage : iirDownStages) {
-            stage.setNumChannels(numChannels);
+            stage.snapToZero();
+        }
+        for(auto& stage : allpassUpStages) {
+            stage.snapToZero();
+        }
+        for(auto& stage : allpassDownStages) {
+            stage.snapToZero();
         }
+    }
 
-        reset();
-        manipulatedBufferIsA = true;
+    //===== Oversampler =====
+
+    template<typename Type>
+    Oversampler<Type>::Oversampler()
+    {
     }
 
     template<typename Type>
-    void Oversampler<Type>::reset() noexcept
+    void Oversampler<Type>::setNumStages(int newNumStages)
     {
-        firUp.reset();
-        firDown.reset();
+        newNumStages = newNumStages < 0 ? 0 : newNumStages;
 
-        for(auto& stage : iirUpStages) {
-            stage.reset();
+        if(newNumStages <= maxNumStages)
+        {
+            switchChain(newNumStages, true);
+            return;
         }
-        for(auto& stage : iirDownStages) {
-            stage.reset();
+
+        // beyond what was prepared for - grow the stage lists; prepare() has to follow
+        maxNumStages = newNumStages;
+        numStages = newNumStages;
+        pendingNumStages = -1;
+        crossfading = false;
+
+        for(auto& chain : chains)
+        {
+            chain.setMaxStages(maxNumStages);
+            chain.numStages = numStages;
         }
+    }
 
-        for(auto& channelData : bufferA) {
-            std::fill(channelData.begin(), channelData.end(), static_cast<Type>(0.0));
+    template<typename Type>
+    void Oversampler<Type>::switchChain(int newNumStages, bool withCrossfade) noexcept
+    {
+        if(crossfading)
+        {
+            pendingNumStages = newNumStages;
+            return;
         }
-        for(auto& channelData : bufferB) {
-            std::fill(channelData.begin(), channelData.end(), static_cast<Type>(0.0));
+
+        pendingNumStages = -1;
+        if(newNumStages == numStages) {
+            return;
+        }
+
+        auto& from = chains[activeChain];
+        auto& to = chains[1 - activeChain];
+
+        // same preset, stage type and stage count on both sides, so this is assignment into storage
+        // that's already the right size
+        to = from;
+
+        // only the stages that were running in from have state worth keeping; the rest hold whatever
+        // they had when they last ran, which with from at 0 stages includes the FIRs
+        if(from.numStages == 0) {
+            to.reset();
+        }
+        else {
+            to.resetStagesAbove(std::min(from.numStages, newNumStages));
         }
+        to.numStages = newNumStages;
+
+        activeChain = 1 - activeChain;
+        numStages = newNumStages;
+
+        crossfading = withCrossfade && crossfadeLength > 0;
+        crossfadeDelay = getLatency();
+        crossfadePosition = 0;
     }
 
     template<typename Type>
-    void Oversampler<Type>::snapToZero() noexcept
+    void Oversampler<Type>::finishCrossfade(bool crossfadePendingChange) noexcept
     {
-        for(auto& stage : iirUpStages) {
-            stage.snapToZero();
+        crossfading = false;
+        if(pendingNumStages >= 0) {
+            switchChain(pendingNumStages, crossfadePendingChange);
         }
-        for(auto& stage : iirDownStages) {
-            stage.snapToZero();
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::setIIRStageType(OversamplerIIRStageType newType)
+    {
+        iirStageType = newType;
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::setSubBlockSize(int newSubBlockSize)
+    {
+        subBlockSize = static_cast<size_t>(std::max(1, newSubBlockSize));
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::setWorkerPool(WorkerPool* newWorkerPool) noexcept
+    {
+        workerPool = newWorkerPool;
+    }
+
+    template<typename Type>
+    bool Oversampler<Type>::useMultichannelFIR() const noexcept
+    {
+        // with a pool each task filters only its own channels, so the FIR has to run per channel - and
+        // then always, since the two modes keep separate histories
+        return workerPool == nullptr && numChannels >= multichannelFIRThreshold;
+    }
+
+    template<typename Type>
+    int Oversampler<Type>::getNumWorkerTasks() const noexcept
+    {
+        if(workerPool == nullptr) {
+            return 1;
         }
+        return std::clamp(workerPool->getNumThreads() + 1, 1, std::max(1, numChannels));
     }
 
     template<typename Type>
-    size_t Oversampler<Type>::getLatency() const noexcept
+    std::pair<int, int> Oversampler<Type>::getChannelRange(int task, int numTasks) const noexcept
     {
-        return numStages == 0 ? size_t{0} : size_t{66};
+        return { task * numChannels / numTasks, (task + 1) * numChannels / numTasks };
     }
 
     template<typename Type>
-    size_t Oversampler<Type>::upsample(Type** input, size_t numSamples) noexcept
+    void Oversampler<Type>::setCrossfadeLength(int numSamples) noexcept
+    {
+        crossfadeLength = static_cast<size_t>(std::max(0, numSamples));
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::setFIRPreset(OversamplerFIRPreset newPreset)
     {
-        currentLength = numSamples;
-        if(numStages == 0)
+        for(auto& chain : chains)
         {
-            for(int c = 0; c < numChannels; ++c) {
-                std::copy(input[c], input[c] + numSamples, bufferA[c].begin());
+            switch (newPreset)
+            {
+            case OversamplerFIRPreset::LowLatency:
+                chain.firUp.template emplace<HalfbandFIRFilter<Type, HalfbandFIRDesigns::LowLatency>>();
+                chain.firDown.template emplace<HalfbandFIRFilter<Type, HalfbandFIRDesigns::LowLatency>>();
+                break;
+
+            case OversamplerFIRPreset::Balanced:
+                chain.firUp.template emplace<HalfbandFIRFilter<Type, HalfbandFIRDesigns::Balanced>>();
+                chain.firDown.template emplace<HalfbandFIRFilter<Type, HalfbandFIRDesigns::Balanced>>();
+                break;
+
+            default:
+                chain.firUp.template emplace<HalfbandFIRFilter<Type, HalfbandFIRDesigns::HighQuality>>();
+                chain.firDown.template emplace<HalfbandFIRFilter<Type, HalfbandFIRDesigns::HighQuality>>();
+                break;
             }
-            manipulatedBufferIsA = true;
-            return numSamples;
         }
+    }
 
-        auto* currentBuffers = &bufferA;
-        auto* otherBuffers = &bufferB;
+    template<typename Type>
+    void Oversampler<Type>::prepare(int newNumChannels, int newMaximumBlockSize)
+    {
+        prepareForMaxStages(numStages, newNumChannels, newMaximumBlockSize);
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::prepareForMaxStages(int maxStages, int newNumChannels, int newMaximumBlockSize)
+    {
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
 
-        for(int c = 0; c < numChannels; ++c) {
-            firUp.interpolate(std::span<const Type>(input[c], currentLength),
-                               std::span<Type>((*currentBuffers)[c]).first(currentLength * 2), c);
+        // a pending or half-finished change is settled here, not carried across
+        if(pendingNumStages >= 0) {
+            numStages = pendingNumStages;
         }
-        currentLength *= 2;
+        pendingNumStages = -1;
+        crossfading = false;
+
+        maxNumStages = std::max(0, maxStages);
+        numStages = std::min(numStages, maxNumStages);
 
-        for(int stage = 2; stage <= numStages; ++stage)
+        for(auto& chain : chains)
         {
-            std::swap(currentBuffers, otherBuffers);
-            auto& filter = iirUpStages[stage - 2];
+            chain.setMaxStages(maxNumStages);
+            chain.numStages = numStages;
+            chain.setNumChannels(numChannels);
+        }
 
-            for(int c = 0; c < numChannels; ++c) {
-                filter.interpolate(std::span<const Type>((*otherBuffers)[c]).first(currentLength),
-                                    std::span<Type>((*currentBuffers)[c]).first(currentLength * 2), c);
-            }
-            currentLength *= 2;
+        const auto maxLength = static_cast<size_t>(maximumBlockSize) << maxNumStages;
+        const auto scratchLength = maxNumStages > 1 ? subBlockSize << (maxNumStages - 1) : 0;
+
+        internalBuffer.assign(numChannels, std::vector<Type>(maxLength, static_cast<Type>(0.0)));
+        scratchA.assign(numChannels, std::vector<Type>(scratchLength, static_cast<Type>(0.0)));
+        scratchB.assign(numChannels, std::vector<Type>(scratchLength, static_cast<Type>(0.0)));
+        kernelBuffer.assign(numChannels, std::vector<Type>(subBlockSize << maxNumStages, static_cast<Type>(0.0)));
+        crossfadeBuffer.assign(numChannels, std::vector<Type>(subBlockSize, static_cast<Type>(0.0)));
+
+        internalBufferPointers.resize(numChannels);
+        kernelBufferPointers.resize(numChannels);
+        crossfadeBufferPointers.resize(numChannels);
+        for(int c = 0; c < numChannels; ++c)
+        {
+            internalBufferPointers[c] = internalBuffer[c].data();
+            kernelBufferPointers[c] = kernelBuffer[c].data();
+            crossfadeBufferPointers[c] = crossfadeBuffer[c].data();
+        }
+
+        firInputPointers.assign(numChannels, nullptr);
+        firOutputPointers.assign(numChannels, nullptr);
+
+        reset();
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::reset() noexcept
+    {
+        for(auto& chain : chains) {
+            chain.reset();
+        }
+
+        for(auto& channelData : internalBuffer) {
+            std::fill(channelData.begin(), channelData.end(), static_cast<Type>(0.0));
+        }
+
+        // nothing left to fade from
+        finishCrossfade(false);
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::snapToZero() noexcept
+    {
+        for(auto& chain : chains) {
+            chain.snapToZero();
+        }
+    }
+
+    template<typename Type>
+    size_t Oversampler<Type>::getLatency() const noexcept
+    {
+        if(numStages == 0) {
+            return 0;
+        }
+        return std::visit([](const auto& fir) { return static_cast<size_t>(fir.roundTripLatency); }, chains[activeChain].firUp);
+    }
+
+    template<typename Type>
+    size_t Oversampler<Type>::upsample(Type** input, size_t numSamples) noexcept
+    {
+        // the split API has nowhere to run a second chain, so a change just takes effect here
+        finishCrossfade(false);
+
+        currentLength = numSamples << numStages;
+
+        const auto numTasks = getNumWorkerTasks();
+        if(numTasks > 1)
+        {
+            auto runTask = [&](int task)
+            {
+                const auto [firstChannel, endChannel] = getChannelRange(task, numTasks);
+                upsampleChannels(input, numSamples, firstChannel, endChannel);
+            };
+            workerPool->run(runTask, numTasks);
+        }
+        else
+        {
+            upsampleChannels(input, numSamples, 0, numChannels);
         }
 
-        manipulatedBufferIsA = (currentBuffers == &bufferA);
         return currentLength;
     }
 
     template<typename Type>
-    size_t Oversampler<Type>::upsample(const AudioBuffer<Type>& buffer) noexcept
+    void Oversampler<Type>::upsampleChannels(Type* const* input, size_t numSamples, int firstChannel, int endChannel) noexcept
     {
-        return upsample(buffer.data(), buffer.numFrames());
+        for(size_t start = 0; start < numSamples; start += subBlockSize) {
+            upsampleSubBlock(chains[activeChain], input, start, std::min(numSamples - start, subBlockSize),
+                             internalBufferPointers.data(), start << numStages, firstChannel, endChannel);
+        }
+    }
+
+    template<typename Type>
+    void Oversampler<Type>::upsampleSubBlock(Chain& chain, Type* const* input, size_t start, size_t count,
+                                             Type* const* highRate, size_t highRateStart,
+                                             int firstChannel, int endChannel) noexcept
+    {
+        const auto chainStages = chain.numStages;
+        if(chainStages == 0)
+        {
+            for(int c = firstChannel; c < endChannel; ++c) {
+                std::copy(input[c] + start, input[c] + start + count, highRate[c] + highRateStart);
+            }
+            return;
+        }
+
+        // with a single stage the FIR writes straight into the high-rate destination, otherwise into scratchA
+        for(int c = firstChannel; c < endChannel; ++c)
+        {
+            firInputPointers[c] = input[c] + start;
+            firOutputPointers[c] = (chainStages == 1) ? highRate[c] + highRateStart : scratchA[c].data();
+        }
+
+        std::visit([&](auto& fir)
+        {
+            if(useMultichannelFIR())
+            {
+                fir.interpolate(firInputPointers.data(), firOutputPointers.data(), count);
+            }
+            else
+            {
+                for(int c = firstChannel; c < endChannel; ++c) {
+                    fir.interpolate(firInputPointers[c], firOutputPointers[c], count, c);
+                }
+            }
+        }, chain.firUp);
+
+        // the remaining stages ping-pong through the scratch buffers, the last one landing in the
+        // high-rate destination
+        auto interpolateStages = [&](auto& stages)
+        {
+            for(int c = firstChannel; c < endChannel; ++c)
+            {
+                auto* current = scratchA[c].data();
+                auto* other = scratchB[c].data();
+                auto length = 2 * count;
+
+                for(int stage = 2; stage <= chainStages; ++stage)
+                {
+                    auto* destination = (stage == chainStages) ? highRate[c] + highRateStart : other;
+                    stages[stage - 2].interpolate(current, destination, length, c);
+
+                    std::swap(current, other);
+                    length *= 2;
+                }
+            }
+        };
+
+        if(iirStageType == OversamplerIIRStageType::PolyphaseAllpass) {
+            interpolateStages(chain.allpassUpStages);
+        }
+        else {
+            interpolateStages(chain.iirUpStages);
+        }
     }
 
     template<typename Type>
-    Type** Oversampler<Type>::manipulatedBufferPointers() noexcept
+    size_t Oversampler<Type>::upsample(const AudioBuffer<Type>& buffer) noexcept
     {
-        return manipulatedBufferIsA ? bufferAPointers.data() : bufferBPointers.data();
+        return upsample(buffer.data(), buffer.numFrames());
     }
 
     template<typename Type>
     Type** Oversampler<Type>::getInternalBufferData() noexcept
     {
-        return manipulatedBufferPointers();
+        return internalBufferPointers.data();
     }
 
     template<typename Type>
     AudioBuffer<Type> Oversampler<Type>::getInternalBuffer() noexcept
     {
-        return AudioBuffer<Type>(manipulatedBufferPointers(), numChannels, currentLength);
+        return AudioBuffer<Type>(internalBufferPointers.data(), numChannels, currentLength);
     }
 
     template<typename Type>
@@ -173,43 +464,97 @@ namespace IADSP
         // return span covering the number of oversampled samples that represent this sample in this channel
         // if the oversampling factor is two, this will return 2 elements, if it is 4 then 4 elements etc.
         const auto factor = static_cast<size_t>(getOversamplingFactor());
-        return std::span<Type>(manipulatedBufferPointers()[channel], currentLength)
+        return std::span<Type>(internalBufferPointers[channel], currentLength)
                    .subspan(originalSamplePos * factor, factor);
     }
 
     template<typename Type>
     void Oversampler<Type>::downsample(Type** output, size_t numSamples) noexcept
     {
-        if(numStages == 0)
+        const auto numTasks = getNumWorkerTasks();
+        if(numTasks > 1)
         {
-            auto& source = manipulatedBufferIsA ? bufferA : bufferB;
-            for(int c = 0; c < numChannels; ++c) {
-                std::copy(source[c].begin(), source[c].begin() + numSamples, output[c]);
-            }
-            return;
+            auto runTask = [&](int task)
+            {
+                const auto [firstChannel, endChannel] = getChannelRange(task, numTasks);
+                downsampleChannels(output, numSamples, firstChannel, endChannel);
+            };
+            workerPool->run(runTask, numTasks);
+        }
+        else
+        {
+            downsampleChannels(output, numSamples, 0, numChannels);
         }
+    }
 
-        auto* currentBuffers = manipulatedBufferIsA ? &bufferA : &bufferB;
-        auto* otherBuffers = manipulatedBufferIsA ? &bufferB : &bufferA;
-        size_t length = numSamples << numStages;
+    template<typename Type>
+    void Oversampler<Type>::downsampleChannels(Type* const* output, size_t numSamples, int firstChannel, int endChannel) noexcept
+    {
+        for(size_t start = 0; start < numSamples; start += subBlockSize) {
+            downsampleSubBlock(chains[activeChain], internalBufferPointers.data(), start << numStages,
+                               output, start, std::min(numSamples - start, subBlockSize), firstChannel, endChannel);
+        }
+    }
 
-        for(int stage = numStages; stage >= 2; --stage)
+    template<typename Type>
+    void Oversampler<Type>::downsampleSubBlock(Chain& chain, Type* const* highRate, size_t highRateStart,
+                                               Type* const* output, size_t start, size_t count,
+                                               int firstChannel, int endChannel) noexcept
+    {
+        const auto chainStages = chain.numStages;
+        if(chainStages == 0)
         {
-            std::swap(currentBuffers, otherBuffers);
-            const auto outputLength = length / 2;
-            auto& filter = iirDownStages[stage - 2];
-
-            for(int c = 0; c < numChannels; ++c) {
-                filter.decimate(std::span<const Type>((*otherBuffers)[c]).first(length),
-                                 std::span<Type>((*currentBuffers)[c]).first(outputLength), c);
+            for(int c = firstChannel; c < endChannel; ++c) {
+                std::copy(highRate[c] + highRateStart, highRate[c] + highRateStart + count, output[c] + start);
             }
-            length = outputLength;
+            return;
         }
 
-        for(int c = 0; c < numChannels; ++c) {
-            firDown.decimate(std::span<const Type>((*currentBuffers)[c]).first(numSamples * 2),
-                              std::span<Type>(output[c], numSamples), c);
+        // every stage but the FIR reads from the high-rate source or the previous stage's scratch and
+        // writes to the other scratch buffer; wherever the last of them ends up is the FIR's input
+        auto decimateStages = [&](auto& stages)
+        {
+            for(int c = firstChannel; c < endChannel; ++c)
+            {
+                const Type* current = highRate[c] + highRateStart;
+                auto* destination = scratchA[c].data();
+                auto* other = scratchB[c].data();
+                auto length = count << (chainStages - 1);
+
+                for(int stage = chainStages; stage >= 2; --stage)
+                {
+                    stages[stage - 2].decimate(current, destination, length, c);
+
+                    current = destination;
+                    std::swap(destination, other);
+                    length /= 2;
+                }
+
+                firInputPointers[c] = current;
+                firOutputPointers[c] = output[c] + start;
+            }
+        };
+
+        if(iirStageType == OversamplerIIRStageType::PolyphaseAllpass) {
+            decimateStages(chain.allpassDownStages);
+        }
+        else {
+            decimateStages(chain.iirDownStages);
         }
+
+        std::visit([&](auto& fir)
+        {
+            if(useMultichannelFIR())
+            {
+                fir.decimate(firInputPointers.data(), firOutputPointers.data(), count);
+            }
+            else
+            {
+                for(int c = firstChannel; c < endChannel; ++c) {
+                    fir.decimate(firInputPointers[c], firOutputPointers[c], count, c);
+                }
+            }
+        }, chain.firDown);
     }
 
     template<typename Type>
@@ -1,7 +1,7 @@
 /*
-This combines a HalfbandFIRFilter (for the first 2x stage) and a cascade of ButterworthHalfbandFilter
-instances (for any further 2x stages) into a multi-stage oversampler, intended as a JUCE-free
-replacement for juce::dsp::Oversampling.
+This combines a HalfbandFIRFilter (for the first 2x stage) and a cascade of IIR halfband filters (for
+any further 2x stages) into a multi-stage oversampler, intended as a JUCE-free replacement for
+juce::dsp::Oversampling.
 
 Usage per block (raw-pointer style):
     auto numUpsampled = oversampler.upsample(input, numSamples);
@@ -15,10 +15,70 @@ Or, using AudioBuffer<Type> instead of raw pointers:
     // ... manipulate internalBuffer in place, numUpsampled frames per channel ...
     oversampler.downsample(outputBuffer);
 
-setNumStages() sets the number of 2x stages (oversampling factor = 2^numStages). Buffers and per-channel
-filter state are all sized ahead of time in prepare() - none of the per-block methods above allocate.
-Calling setNumStages() after prepare() does not itself reallocate; prepare() must be called again before
-the next upsample()/downsample() call, or the (differently-sized) per-block buffers will be overrun.
+Or, when the processing is a per-sample function, fused into a single call:
+    oversampler.process(buffer, numSamples, [](Type x) { return std::tanh(x); });
+    oversampler.process(audioBuffer, [&](Type x, int channel) { return ladder.processSample(x, channel); });
+
+process() runs the kernel on each sub-block right after it is upsampled, while it is still sitting in a
+small scratch buffer, and downsamples it straight back into `buffer` (in place) - the high-rate signal
+never goes through the full-size internal buffer, and since process() is a template defined below, the
+kernel is inlined into the loop over it. The kernel is called once per high-rate sample, channel by
+channel and in time order, with the sample and optionally the channel index. It must not call back into
+the oversampler. getInternalBufferData() and friends aren't meaningful after process(), only after
+upsample().
+
+setFIRPreset() picks which HalfbandFIRDesigns preset the first (FIR) stage uses, per instance - e.g.
+LowLatency for tracking/live monitoring, where its 15 samples of latency (vs 66 for the default
+HighQuality) matter more than the extra stopband. Like setNumStages(), call prepare() again afterwards.
+
+setIIRStageType() picks the filter used for stages 2 and up: AllpassHalfbandFilter (the default - two
+allpass branches running at the low rate, so no work is spent on zero-stuffed samples) or the original
+ButterworthHalfbandFilter cascade. Both are designed to the same band edges and roughly the same
+stopband attenuation per stage. Like setFIRPreset(), call prepare() again afterwards.
+
+setNumStages() sets the number of 2x stages (oversampling factor = 2^numStages; see PolyphaseOversampler
+for 3x, 5x, 6x and other factors that aren't powers of two). Buffers and per-channel filter state are
+all sized ahead of time in prepare() - none of the per-block methods above allocate. prepare() sizes
+everything for the current number of stages; prepareForMaxStages() sizes it for up to maxStages instead.
+Any setNumStages() call at or below what was last prepared for is then realtime-safe (no allocation, no
+prepare() needed) and may be made from the audio thread, between blocks. Raising it above that resizes
+the stage lists (allocating), and prepare() must be called again before the next block.
+
+A realtime stage change switches between two preallocated filter chains. The new chain starts as a copy
+of the old one's filter state - the FIR and the stages the two share see (nearly) the same signal - with
+only the stages it adds starting from silence, so it comes in without a gap. process() additionally
+crossfades from the old chain's output to the new one's over setCrossfadeLength() original-rate samples
+(256 by default), starting once the new chain's reset stages have had getLatency() samples to settle
+and running the kernel on both chains until the fade is done; a kernel with internal state therefore
+sees both signals during that time. Changes made during a fade are held back until it has finished. The
+split upsample()/downsample() API can't run two chains, so there the change simply takes effect at the
+next upsample(), without a crossfade. Switching to or from zero stages changes the latency (see below),
+so those two paths aren't time-aligned while they fade.
+
+Processing is cache-blocked: upsample() and downsample() push sub-blocks of setSubBlockSize() low-rate
+samples (64 by default) through every stage before moving on to the next, so the intermediate stages only
+ever touch two small per-channel scratch buffers (subBlockSize << (numStages - 1) samples each) that stay
+in L1/L2 however large the host block or oversampling factor is. The one full-size buffer left is the
+internal buffer handed out between upsample() and downsample(). Filter state carries across sub-blocks,
+so the sub-block size has no effect on the output. Like setNumStages(), call prepare() again after
+changing it.
+
+From multichannelFIRThreshold channels upwards, the FIR stage runs in HalfbandFIRFilter's multichannel
+mode (channels as SIMD lanes, one pass over the coefficients for all of them) instead of once per channel.
+
+For high channel counts, setWorkerPool() spreads the channels over a WorkerPool: each of upsample(),
+downsample() and process() splits them into one contiguous range per thread (the calling thread takes one
+too) and runs its whole sub-block loop for each range in parallel. Every channel has its own filter state
+and scratch, so the ranges share nothing but the read-only settings. The threads are spawned by the pool
+up front and handed work without locks or allocation, so this stays realtime-safe. The FIR's multichannel
+mode works on all channels at once, so with a pool the FIR always runs once per channel instead (which
+rounds slightly differently - the output matches the single-threaded path exactly below
+multichannelFIRThreshold channels, and to within float rounding above it). That switches FIR histories,
+so call prepare() or reset() after setWorkerPool(). process()'s kernel is then called from several
+threads at once, for different channels - a kernel(sample, channel) with per-channel state is fine, one
+with state shared between channels is not. A process() call made while a stage-change crossfade is
+running (see above) goes single-threaded until the fade has finished. With no pool set, none of this code
+runs and processing is exactly as before.
 
 Only the FIR stage contributes to getLatency(), since the IIR stages don't have a constant group delay
 across frequency the way a linear-phase FIR does.
@@ -31,14 +91,33 @@ classes above.
 #pragma once
 
 #include <vector>
+#include <variant>
 #include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 #include "AudioBuffer.hpp"
+#include "WorkerPool.hpp"
 #include "../IA_Filters/HalfbandFIRFilter.hpp"
 #include "../IA_Filters/ButterworthHalfbandFilter.hpp"
+#include "../IA_Filters/AllpassHalfbandFilter.hpp"
 #include <span>
 
 namespace IADSP
 {
+    enum struct OversamplerFIRPreset
+    {
+        LowLatency,
+        Balanced,
+        HighQuality
+    };
+
+    enum struct OversamplerIIRStageType
+    {
+        PolyphaseAllpass,
+        Butterworth
+    };
+
     template<typename Type>
     class Oversampler
     {
@@ -47,8 +126,22 @@ namespace IADSP
 
         void reset() noexcept;
         void setNumStages(int newNumStages);
+        void setFIRPreset(OversamplerFIRPreset newPreset);
+        void setIIRStageType(OversamplerIIRStageType newType);
+        void setSubBlockSize(int newSubBlockSize);
+        void setCrossfadeLength(int numSamples) noexcept;
+
+        // splits the channel loop across pool's threads (see the top of this file); nullptr (the
+        // default) processes every channel on the calling thread. The pool isn't owned and must outlive
+        // any processing done with it. Call prepare() or reset() after changing it.
+        void setWorkerPool(WorkerPool* pool) noexcept;
+
         void prepare(int numChannels, int maximumBlockSize);
 
+        // like prepare(), but sized for anything up to maxStages, so that setNumStages() can change the
+        // factor in realtime afterwards (see the top of this file)
+        void prepareForMaxStages(int maxStages, int numChannels, int maximumBlockSize);
+
         // numSamples low-rate samples in -> returns numSamples * getOversamplingFactor(), the number of
         // samples now available in the internal buffer
         size_t upsample(Type** input, size_t numSamples) noexcept;
@@ -75,28 +168,197 @@ namespace IADSP
         // downsamples into an audio buffer
         void downsample(AudioBuffer<Type>& buffer) noexcept;
 
-        // latency is approx 1.375ms for a 48kHz original sample rate
+        // upsamples, applies kernel(sample) or kernel(sample, channel) to every high-rate sample, and
+        // downsamples back into buffer, one sub-block at a time (see the top of this file)
+        template<typename Kernel>
+        void process(Type** buffer, size_t numSamples, Kernel&& kernel) noexcept;
+
+        template<typename Kernel>
+        void process(AudioBuffer<Type>& buffer, Kernel&& kernel) noexcept;
+
+        // in original-rate samples: 66 (approx 1.375ms at 48kHz) for the HighQuality FIR preset, 31 for
+        // Balanced and 15 for LowLatency
         size_t getLatency() const noexcept;
         int getOversamplingFactor() const noexcept { return 1 << numStages; }
         void snapToZero() noexcept;
 
     private:
-        // Picks bufferAPointers/bufferBPointers according to manipulatedBufferIsA - shared by
-        // getInternalBufferData(), getInternalBuffer(), and getUpsampledForPosition() so the buffer
-        // ping-pong selection logic only lives in one place.
-        Type** manipulatedBufferPointers() noexcept;
+        static constexpr int multichannelFIRThreshold = 8;
+
+        using FIRFilter = std::variant<HalfbandFIRFilter<Type, HalfbandFIRDesigns::HighQuality>,
+                                       HalfbandFIRFilter<Type, HalfbandFIRDesigns::Balanced>,
+                                       HalfbandFIRFilter<Type, HalfbandFIRDesigns::LowLatency>>;
+
+        // One complete set of filters. Both chains always have the same preset, stage type and number
+        // of stage filters (enough for maxNumStages), so copying one over the other never allocates.
+        struct Chain
+        {
+            FIRFilter firUp, firDown;
+            std::vector<ButterworthHalfbandFilter<Type>> iirUpStages, iirDownStages;
+            std::vector<AllpassHalfbandFilter<Type>> allpassUpStages, allpassDownStages;
+            int numStages = 0;
+
+            void setMaxStages(int maxStages);
+            void setNumChannels(int numChannels);
+            void reset() noexcept;
+            void resetStagesAbove(int stage) noexcept;
+            void snapToZero() noexcept;
+        };
+
+        // run one sub-block of count low-rate samples, starting at low-rate position start, through
+        // every stage of chain, to or from highRate[channel] + highRateStart, for the channels in
+        // [firstChannel, endChannel)
+        void upsampleSubBlock(Chain& chain, Type* const* input, size_t start, size_t count, Type* const* highRate,
+                              size_t highRateStart, int firstChannel, int endChannel) noexcept;
+        void downsampleSubBlock(Chain& chain, Type* const* highRate, size_t highRateStart, Type* const* output,
+                                size_t start, size_t count, int firstChannel, int endChannel) noexcept;
+
+        // the whole of upsample()/downsample()'s sub-block loop, for the channels in [firstChannel, endChannel)
+        void upsampleChannels(Type* const* input, size_t numSamples, int firstChannel, int endChannel) noexcept;
+        void downsampleChannels(Type* const* output, size_t numSamples, int firstChannel, int endChannel) noexcept;
+
+        bool useMultichannelFIR() const noexcept;
 
-        HalfbandFIRFilter<Type> firUp, firDown;
-        std::vector<ButterworthHalfbandFilter<Type>> iirUpStages, iirDownStages;
+        // 1 without a worker pool, otherwise one task per thread (the caller's included), capped at one
+        // channel each; getChannelRange() returns task's [firstChannel, endChannel)
+        int getNumWorkerTasks() const noexcept;
+        std::pair<int, int> getChannelRange(int task, int numTasks) const noexcept;
 
-        std::vector<std::vector<Type>> bufferA, bufferB;
-        std::vector<Type*> bufferAPointers, bufferBPointers;
+        // realtime stage change: the other chain takes over, starting from a copy of this one's state
+        void switchChain(int newNumStages, bool withCrossfade) noexcept;
 
+        // ends any crossfade, then applies a change that was held back by it
+        void finishCrossfade(bool crossfadePendingChange) noexcept;
+
+        Chain chains[2];
+        int activeChain = 0;
+
+        // the full-size internal buffer, plus the small per-channel ping-pong scratch that the stages
+        // between the FIR and the internal buffer work in
+        std::vector<std::vector<Type>> internalBuffer, scratchA, scratchB;
+        std::vector<Type*> internalBufferPointers;
+
+        // one high-rate sub-block per channel, where process() runs its kernel
+        std::vector<std::vector<Type>> kernelBuffer;
+        std::vector<Type*> kernelBufferPointers;
+
+        // one low-rate sub-block per channel: the fading-out chain's input and output during a crossfade
+        std::vector<std::vector<Type>> crossfadeBuffer;
+        std::vector<Type*> crossfadeBufferPointers;
+
+        // per-sub-block channel pointers for the FIR stage's multichannel mode
+        std::vector<const Type*> firInputPointers;
+        std::vector<Type*> firOutputPointers;
+
+        WorkerPool* workerPool = nullptr;
+
+        OversamplerIIRStageType iirStageType = OversamplerIIRStageType::PolyphaseAllpass;
         int numStages = 0;
+        int maxNumStages = 0;
+        int pendingNumStages = -1;
         int numChannels = 0;
         int maximumBlockSize = 0;
-        bool manipulatedBufferIsA = true;
+        size_t subBlockSize = 64;
+
+        size_t crossfadeLength = 256;
+        size_t crossfadeDelay = 0;
+        size_t crossfadePosition = 0;
+        bool crossfading = false;
 
         size_t currentLength = 0;
     };
+
+    template<typename Type>
+    template<typename Kernel>
+    void Oversampler<Type>::process(Type** buffer, size_t numSamples, Kernel&& kernel) noexcept
+    {
+        auto applyKernel = [&](Type* data, size_t length, int channel)
+        {
+            for(size_t i = 0; i < length; ++i)
+            {
+                if constexpr (std::is_invocable_v<Kernel&, Type, int>) {
+                    data[i] = static_cast<Type>(kernel(data[i], channel));
+                }
+                else {
+                    data[i] = static_cast<Type>(kernel(data[i]));
+                }
+            }
+        };
+
+        auto runChain = [&](Chain& chain, Type* const* io, size_t start, size_t count, int firstChannel, int endChannel)
+        {
+            upsampleSubBlock(chain, io, start, count, kernelBufferPointers.data(), 0, firstChannel, endChannel);
+
+            for(int c = firstChannel; c < endChannel; ++c) {
+                applyKernel(kernelBufferPointers[c], count << chain.numStages, c);
+            }
+
+            downsampleSubBlock(chain, kernelBufferPointers.data(), 0, io, start, count, firstChannel, endChannel);
+        };
+
+        // a crossfade mixes across the whole sub-block loop, so it always runs on this thread
+        const auto numTasks = getNumWorkerTasks();
+        if(numTasks > 1 && ! crossfading)
+        {
+            auto runTask = [&](int task)
+            {
+                const auto [firstChannel, endChannel] = getChannelRange(task, numTasks);
+                for(size_t start = 0; start < numSamples; start += subBlockSize) {
+                    runChain(chains[activeChain], buffer, start, std::min(numSamples - start, subBlockSize), firstChannel, endChannel);
+                }
+            };
+            workerPool->run(runTask, numTasks);
+            return;
+        }
+
+        for(size_t start = 0; start < numSamples; start += subBlockSize)
+        {
+            const auto count = std::min(numSamples - start, subBlockSize);
+
+            if(! crossfading)
+            {
+                runChain(chains[activeChain], buffer, start, count, 0, numChannels);
+                continue;
+            }
+
+            // the fading-out chain works on its own copy of the input, then the two are mixed in place
+            for(int c = 0; c < numChannels; ++c) {
+                std::copy(buffer[c] + start, buffer[c] + start + count, crossfadeBufferPointers[c]);
+            }
+
+            runChain(chains[activeChain], buffer, start, count, 0, numChannels);
+            runChain(chains[1 - activeChain], crossfadeBufferPointers.data(), 0, count, 0, numChannels);
+
+            // the new chain is heard only once the stages it reset have settled and that has made it
+            // through the FIRs, crossfadeDelay samples in
+            const auto step = static_cast<Type>(1.0) / static_cast<Type>(crossfadeLength);
+            const auto fadeEnd = crossfadeDelay + crossfadeLength;
+            for(int c = 0; c < numChannels; ++c)
+            {
+                auto* newOutput = buffer[c] + start;
+                const auto* oldOutput = crossfadeBufferPointers[c];
+
+                for(size_t i = 0; i < count; ++i)
+                {
+                    const auto position = crossfadePosition + i + 1;
+                    const auto gain = position >= fadeEnd ? static_cast<Type>(1.0)
+                                    : position <= crossfadeDelay ? static_cast<Type>(0.0)
+                                    : static_cast<Type>(position - crossfadeDelay) * step;
+                    newOutput[i] = oldOutput[i] + gain * (newOutput[i] - oldOutput[i]);
+                }
+            }
+
+            crossfadePosition += count;
+            if(crossfadePosition >= fadeEnd) {
+                finishCrossfade(true);
+            }
+        }
+    }
+
+    template<typename Type>
+    template<typename Kernel>
+    void Oversampler<Type>::process(AudioBuffer<Type>& buffer, Kernel&& kernel) noexcept
+    {
+        process(buffer.data(), buffer.numFrames(), std::forward<Kernel>(kernel));
+    }
 }
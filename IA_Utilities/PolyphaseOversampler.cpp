@@ -0,0 +1,217 @@
+#include "PolyphaseOversampler.hpp"
+#include "VectorOps.hpp"
+#include "../IA_Filters/FIRDesign.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace IADSP
+{
+    template<typename Type>
+    PolyphaseOversampler<Type>::PolyphaseOversampler()
+    {
+        designFilter();
+    }
+
+    template<typename Type>
+    void PolyphaseOversampler<Type>::setFactor(int newFactor)
+    {
+        assert(newFactor >= 1);
+        factor = std::max(1, newFactor);
+        designFilter();
+    }
+
+    template<typename Type>
+    void PolyphaseOversampler<Type>::designFilter()
+    {
+        // windowed sinc cut off at the low-rate Nyquist (1 / (2 * factor) of the high rate), centred on
+        // tap 32 * factor so the delay is a whole number of low-rate samples
+        const auto numTaps = historyLength * factor + 1;
+        const auto centre = (numTaps - 1) / 2;
+        const auto beta = FIRDesign::kaiserBeta(stopbandAttenuationDB);
+
+        std::vector<double> prototype(numTaps);
+        double sum = 0.0;
+        for(int n = 0; n < numTaps; ++n)
+        {
+            const auto k = n - centre;
+            const auto ideal = (k == 0) ? 1.0 / factor
+                                        : std::sin(std::numbers::pi * k / factor) / (std::numbers::pi * k);
+            prototype[n] = ideal * FIRDesign::kaiserWindow(n, numTaps, beta);
+            sum += prototype[n];
+        }
+
+        // normalise to exactly unity gain at DC
+        taps.resize(numTaps);
+        for(int n = 0; n < numTaps; ++n) {
+            taps[n] = static_cast<Type>(prototype[numTaps - 1 - n] / sum);
+        }
+
+        // phase p produces output sample m * factor + p from taps p, p + factor, p + 2 * factor, ...
+        // applied newest-first - stored oldest-first to match the history layout, zero-padded to
+        // tapsPerPhase (only phase 0 actually has all 65)
+        phaseTaps.assign(static_cast<size_t>(factor) * tapsPerPhase, static_cast<Type>(0.0));
+        for(int p = 0; p < factor; ++p)
+        {
+            for(int j = 0; j < tapsPerPhase; ++j)
+            {
+                const auto n = (tapsPerPhase - 1 - j) * factor + p;
+                if(n < numTaps) {
+                    phaseTaps[p * tapsPerPhase + j] = static_cast<Type>(factor * prototype[n] / sum);
+                }
+            }
+        }
+    }
+
+    template<typename Type>
+    void PolyphaseOversampler<Type>::prepare(int newNumChannels, int newMaximumBlockSize)
+    {
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+
+        const auto maxLength = static_cast<size_t>(maximumBlockSize) * factor;
+        internalBuffer.assign(numChannels, std::vector<Type>(maxLength, static_cast<Type>(0.0)));
+
+        internalBufferPointers.resize(numChannels);
+        for(int c = 0; c < numChannels; ++c) {
+            internalBufferPointers[c] = internalBuffer[c].data();
+        }
+
+        upHistory.assign(numChannels, std::vector<Type>(historyLength + blockLength, static_cast<Type>(0.0)));
+        downHistory.assign(numChannels, std::vector<Type>(static_cast<size_t>(historyLength + blockLength) * factor,
+                                                          static_cast<Type>(0.0)));
+
+        reset();
+    }
+
+    template<typename Type>
+    void PolyphaseOversampler<Type>::reset() noexcept
+    {
+        for(auto* buffers : { &upHistory, &downHistory, &internalBuffer })
+        {
+            for(auto& channelData : *buffers) {
+                std::fill(channelData.begin(), channelData.end(), static_cast<Type>(0.0));
+            }
+        }
+    }
+
+    template<typename Type>
+    size_t PolyphaseOversampler<Type>::getLatency() const noexcept
+    {
+        // half the prototype's length each way
+        return factor > 1 ? static_cast<size_t>(historyLength) : 0;
+    }
+
+    template<typename Type>
+    size_t PolyphaseOversampler<Type>::upsample(Type** input, size_t numSamples) noexcept
+    {
+        currentLength = numSamples * factor;
+        if(factor == 1)
+        {
+            for(int c = 0; c < numChannels; ++c) {
+                std::copy(input[c], input[c] + numSamples, internalBuffer[c].begin());
+            }
+            return currentLength;
+        }
+
+        const auto* phases = phaseTaps.data();
+        const auto numPhases = static_cast<size_t>(factor);
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            auto* history = upHistory[c].data();
+            auto* out = internalBuffer[c].data();
+
+            for(size_t start = 0; start < numSamples; start += blockLength)
+            {
+                const auto count = std::min(numSamples - start, static_cast<size_t>(blockLength));
+                std::copy(input[c] + start, input[c] + start + count, history + historyLength);
+
+                for(size_t i = 0; i < count; ++i)
+                {
+                    // history[i] .. history[historyLength + i] are the newest tapsPerPhase inputs, oldest first
+                    auto* frame = out + (start + i) * numPhases;
+                    for(size_t p = 0; p < numPhases; ++p) {
+                        frame[p] = VectorOps::dotProduct(phases + p * tapsPerPhase, history + i, tapsPerPhase);
+                    }
+                }
+
+                std::copy(history + count, history + count + historyLength, history);
+            }
+        }
+
+        return currentLength;
+    }
+
+    template<typename Type>
+    size_t PolyphaseOversampler<Type>::upsample(const AudioBuffer<Type>& buffer) noexcept
+    {
+        return upsample(buffer.data(), buffer.numFrames());
+    }
+
+    template<typename Type>
+    Type** PolyphaseOversampler<Type>::getInternalBufferData() noexcept
+    {
+        return internalBufferPointers.data();
+    }
+
+    template<typename Type>
+    AudioBuffer<Type> PolyphaseOversampler<Type>::getInternalBuffer() noexcept
+    {
+        return AudioBuffer<Type>(internalBufferPointers.data(), numChannels, currentLength);
+    }
+
+    template<typename Type>
+    std::span<Type> PolyphaseOversampler<Type>::getUpsampledForPosition(size_t channel, size_t originalSamplePos) noexcept
+    {
+        const auto step = static_cast<size_t>(factor);
+        return std::span<Type>(internalBufferPointers[channel], currentLength).subspan(originalSamplePos * step, step);
+    }
+
+    template<typename Type>
+    void PolyphaseOversampler<Type>::downsample(Type** output, size_t numSamples) noexcept
+    {
+        if(factor == 1)
+        {
+            for(int c = 0; c < numChannels; ++c) {
+                std::copy(internalBuffer[c].begin(), internalBuffer[c].begin() + numSamples, output[c]);
+            }
+            return;
+        }
+
+        const auto step = static_cast<size_t>(factor);
+        const auto highRateHistory = static_cast<size_t>(historyLength) * step;
+        const auto numTaps = highRateHistory + 1;
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            auto* history = downHistory[c].data();
+            const auto* in = internalBuffer[c].data();
+
+            for(size_t start = 0; start < numSamples; start += blockLength)
+            {
+                const auto count = std::min(numSamples - start, static_cast<size_t>(blockLength));
+                std::copy(in + start * step, in + (start + count) * step, history + highRateHistory);
+
+                // output i is the filter evaluated at the first high-rate sample of its group, which sits
+                // at history[highRateHistory + i * step]; the window reaches highRateHistory samples back
+                for(size_t i = 0; i < count; ++i) {
+                    output[c][start + i] = VectorOps::dotProduct(taps.data(), history + i * step, numTaps);
+                }
+
+                std::copy(history + count * step, history + count * step + highRateHistory, history);
+            }
+        }
+    }
+
+    template<typename Type>
+    void PolyphaseOversampler<Type>::downsample(AudioBuffer<Type>& buffer) noexcept
+    {
+        downsample(buffer.data(), buffer.numFrames());
+    }
+
+    //==============================================================================
+    template class PolyphaseOversampler<float>;
+    template class PolyphaseOversampler<double>;
+}
@@ -0,0 +1,97 @@
+/*
+This is a single-stage oversampler for integer factors that aren't powers of two - mainly 3x, 5x and
+6x, where Oversampler would have to round up to 4x or 8x and spend the difference on samples nobody
+asked for (e.g. 3x is usually plenty for heavy saturation at 96kHz, and 4x costs a third more).
+
+It has the same per-block interface and preallocation rules as Oversampler:
+    auto numUpsampled = oversampler.upsample(input, numSamples);
+    auto** buffer = oversampler.getInternalBufferData();
+    // ... manipulate `buffer` in place, numUpsampled samples per channel ...
+    oversampler.downsample(output, numSamples);
+with setFactor() taking the place of setNumStages(). Buffers, coefficients and per-channel history are
+all sized in prepare() (call it again after setFactor()) and none of the per-block methods allocate.
+
+Both directions use the same Kaiser-windowed sinc lowpass (see IA_Filters/FIRDesign.hpp), cut off at the
+original Nyquist with a 100dB stopband and taps = 64 * factor + 1, which puts the transition band at
+roughly 0.9 - 1.1 of the original Nyquist at every factor - the same band edges as Oversampler's
+HighQuality halfband. Interpolation is done polyphase: each of the factor output phases is its own
+65-tap FIR over the original-rate input, so nothing is ever multiplied by a stuffed zero. Decimation
+only evaluates the full filter at the output samples it keeps. Like HalfbandFIRFilter, history is kept
+block-contiguous and the dot products go through IA_Utilities/VectorOps.hpp.
+
+The filter is linear phase with a group delay of 32 original-rate samples each way, so getLatency()
+reports a fixed 64 samples for the round trip at every factor.
+
+Like Oversampler, this class is wrapped in namespace IADSP even though it lives in IA_Utilities.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <span>
+#include "AudioBuffer.hpp"
+
+namespace IADSP
+{
+    template<typename Type>
+    class PolyphaseOversampler
+    {
+    public:
+        PolyphaseOversampler();
+
+        void reset() noexcept;
+
+        // any integer factor >= 1 works, but 3, 5 and 6 are what this class is for - use Oversampler
+        // for powers of two
+        void setFactor(int newFactor);
+        void prepare(int numChannels, int maximumBlockSize);
+
+        // numSamples low-rate samples in -> returns numSamples * getOversamplingFactor(), the number of
+        // samples now available in the internal buffer
+        size_t upsample(Type** input, size_t numSamples) noexcept;
+        size_t upsample(const AudioBuffer<Type>& buffer) noexcept;
+
+        // valid between upsample() and downsample(), as for Oversampler
+        Type** getInternalBufferData() noexcept;
+        AudioBuffer<Type> getInternalBuffer() noexcept;
+        std::span<Type> getUpsampledForPosition(size_t channel, size_t originalSamplePos) noexcept;
+
+        // numSamples is the ORIGINAL (pre-oversampling) sample count - the same value passed to upsample()
+        void downsample(Type** output, size_t numSamples) noexcept;
+        void downsample(AudioBuffer<Type>& buffer) noexcept;
+
+        // in original-rate samples: always 64 (see above), or 0 at a factor of 1
+        size_t getLatency() const noexcept;
+        int getOversamplingFactor() const noexcept { return factor; }
+
+        // nothing recursive to flush - here so the two oversamplers can be swapped for each other
+        void snapToZero() noexcept {}
+
+    private:
+        static constexpr int tapsPerPhase = 65;
+        static constexpr int historyLength = tapsPerPhase - 1;
+        static constexpr int blockLength = 128;
+        static constexpr double stopbandAttenuationDB = 100.0;
+
+        void designFilter();
+
+        int factor = 3;
+        int numChannels = 0;
+        int maximumBlockSize = 0;
+        size_t currentLength = 0;
+
+        // the prototype lowpass, reversed for the decimator's dot product (it is symmetric, so in
+        // practice just the taps), and split into factor phases of tapsPerPhase taps each for the
+        // interpolator, each phase reversed and scaled by factor to make up for the inserted zeros
+        std::vector<Type> taps;
+        std::vector<Type> phaseTaps;
+
+        // per channel: historyLength low-rate (up) or historyLength * factor high-rate (down) samples of
+        // history, followed by room for one block
+        std::vector<std::vector<Type>> upHistory, downHistory;
+
+        std::vector<std::vector<Type>> internalBuffer;
+        std::vector<Type*> internalBufferPointers;
+    };
+}
@@ -0,0 +1,192 @@
+#include "RationalResampler.hpp"
+#include "VectorOps.hpp"
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+namespace IADSP
+{
+    template<typename Type>
+    RationalResampler<Type>::RationalResampler()
+    {
+        table = getTable(upFactor, downFactor, quality);
+    }
+
+    template<typename Type>
+    void RationalResampler<Type>::setRates(int inputRate, int outputRate)
+    {
+        assert(inputRate > 0 && outputRate > 0);
+        inputRate = std::max(1, inputRate);
+        outputRate = std::max(1, outputRate);
+
+        const auto divisor = std::gcd(inputRate, outputRate);
+        upFactor = outputRate / divisor;
+        downFactor = inputRate / divisor;
+        updateTable();
+    }
+
+    template<typename Type>
+    void RationalResampler<Type>::setQuality(ResamplerQuality newQuality)
+    {
+        quality = newQuality;
+        updateTable();
+    }
+
+    template<typename Type>
+    void RationalResampler<Type>::updateTable()
+    {
+        table = getTable(upFactor, downFactor, quality);
+
+        // the history is sized for the kernel, which may just have changed length
+        if(! history.empty()) {
+            prepare(numChannels, maximumBlockSize);
+        }
+    }
+
+    template<typename Type>
+    std::shared_ptr<const typename RationalResampler<Type>::Table> RationalResampler<Type>::getTable(int upFactor, int downFactor,
+                                                                                                       ResamplerQuality quality)
+    {
+        // the cache only holds weak references, so a table lives exactly as long as some resampler uses it
+        static std::mutex cacheLock;
+        static std::map<std::tuple<int, int, ResamplerQuality>, std::weak_ptr<const Table>> cache;
+
+        const std::lock_guard<std::mutex> lock(cacheLock);
+        auto& entry = cache[{ upFactor, downFactor, quality }];
+        if(auto existing = entry.lock()) {
+            return existing;
+        }
+
+        auto created = designTable(upFactor, downFactor, quality);
+        entry = created;
+        return created;
+    }
+
+    template<typename Type>
+    std::shared_ptr<const typename RationalResampler<Type>::Table> RationalResampler<Type>::designTable(int upFactor, int downFactor,
+                                                                                                          ResamplerQuality quality)
+    {
+        const auto shape = ResamplerKernelShape::forRatio(quality, static_cast<double>(downFactor) / upFactor);
+        const auto kernelLength = static_cast<size_t>(shape.length);
+        const auto halfLength = 0.5 * static_cast<double>(kernelLength);
+
+        auto newTable = std::make_shared<Table>();
+        newTable->kernelLength = kernelLength;
+        newTable->coefficients.resize(static_cast<size_t>(upFactor) * kernelLength);
+        newTable->advance.resize(static_cast<size_t>(upFactor));
+        std::vector<double> row(kernelLength);
+
+        for(int j = 0; j < upFactor; ++j)
+        {
+            // output j of the cycle sits at input position j * M / L: a whole part, and a phase offset
+            // that is a whole number of Lths
+            const auto position = static_cast<long long>(j) * downFactor;
+            const auto offset = static_cast<double>(position % upFactor) / upFactor;
+            const auto nextPosition = position + downFactor;
+            newTable->advance[j] = static_cast<size_t>(nextPosition / upFactor - position / upFactor);
+
+            // tap k is applied to the input sample (halfLength - 1 - k + offset) samples before it
+            double sum = 0.0;
+            for(size_t k = 0; k < kernelLength; ++k)
+            {
+                row[k] = resamplerKernel(shape, offset + halfLength - 1.0 - static_cast<double>(k));
+                sum += row[k];
+            }
+
+            auto* destination = newTable->coefficients.data() + static_cast<size_t>(j) * kernelLength;
+            for(size_t k = 0; k < kernelLength; ++k) {
+                destination[k] = static_cast<Type>(row[k] / sum);
+            }
+        }
+
+        return newTable;
+    }
+
+    template<typename Type>
+    void RationalResampler<Type>::prepare(int newNumChannels, int newMaximumBlockSize)
+    {
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+
+        // what's left after a call is always less than one window
+        history.assign(numChannels, std::vector<Type>(table->kernelLength + maximumBlockSize, static_cast<Type>(0.0)));
+        reset();
+    }
+
+    template<typename Type>
+    void RationalResampler<Type>::reset() noexcept
+    {
+        for(auto& h : history) {
+            std::fill(h.begin(), h.end(), static_cast<Type>(0.0));
+        }
+
+        // start with the first output centred on the first input sample, preceded by silence
+        numBuffered = table->kernelLength / 2 - 1;
+        windowStart = 0;
+        cyclePosition = 0;
+    }
+
+    template<typename Type>
+    size_t RationalResampler<Type>::getMaxOutputSamples(size_t numInputSamples) const noexcept
+    {
+        // as for StreamingResampler: the window can move on by at most numInputSamples + 1
+        return ((numInputSamples + 1) * static_cast<size_t>(upFactor) + static_cast<size_t>(downFactor) - 1) / static_cast<size_t>(downFactor);
+    }
+
+    template<typename Type>
+    size_t RationalResampler<Type>::process(const Type* const* input, size_t numInputSamples, Type* const* output) noexcept
+    {
+        assert(numInputSamples <= static_cast<size_t>(maximumBlockSize));
+
+        const auto kernelLength = table->kernelLength;
+        const auto* coefficients = table->coefficients.data();
+        const auto* advance = table->advance.data();
+        const auto cycleLength = static_cast<size_t>(upFactor);
+        const auto available = numBuffered + numInputSamples;
+
+        size_t numOutput = 0;
+        size_t nextWindowStart = windowStart;
+        size_t nextCyclePosition = cyclePosition;
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            auto* buffer = history[c].data();
+            std::copy(input[c], input[c] + numInputSamples, buffer + numBuffered);
+
+            // every channel replays the same cycle from the shared starting point
+            auto start = windowStart;
+            auto j = cyclePosition;
+            auto* out = output[c];
+            numOutput = 0;
+
+            while(start + kernelLength <= available)
+            {
+                out[numOutput++] = VectorOps::dotProduct(coefficients + j * kernelLength, buffer + start, kernelLength);
+                start += advance[j];
+                j = (j + 1 == cycleLength) ? 0 : j + 1;
+            }
+
+            nextWindowStart = start;
+            nextCyclePosition = j;
+        }
+
+        // slide whatever the next window still needs down to the front; a window start beyond the
+        // buffered input (only possible when M / L exceeds the kernel length) carries over as a skip
+        const auto consumed = std::min(nextWindowStart, available);
+        for(auto& h : history) {
+            std::copy(h.begin() + consumed, h.begin() + available, h.begin());
+        }
+
+        numBuffered = available - consumed;
+        windowStart = nextWindowStart - consumed;
+        cyclePosition = nextCyclePosition;
+        return numOutput;
+    }
+
+    //==============================================================================
+    template class RationalResampler<float>;
+    template class RationalResampler<double>;
+}
@@ -0,0 +1,102 @@
+/*
+This is a fixed-ratio polyphase resampler for conversions between rates with a simple rational
+relationship - 44.1kHz <-> 48kHz (147/160), 2x, 4x, 48kHz -> 32kHz and the like - where
+StreamingResampler's fractional position would just keep recomputing the same handful of interpolation
+phases.
+
+    resampler.setRates(44100, 48000);                       // reduced to 147/160 internally
+    resampler.prepare(numChannels, maximumInputBlockSize);
+    auto numOut = resampler.process(input, numIn, output);  // output needs getMaxOutputSamples(numIn)
+
+The ratio is reduced to L/M (L = upsampling, M = downsampling factor) by their greatest common divisor.
+Output n then sits exactly at input position n * M / L, so the outputs repeat the same L interpolation
+phases in a fixed cycle. The coefficient table holds one row of taps per output in that cycle, already
+in cycle order, along with how far each output moves the input window on - so the inner loop is just a
+dot product (through IA_Utilities/VectorOps.hpp), a pointer bump and a row index that wraps, with no
+phase arithmetic and no interpolation between rows. The rows are the same Kaiser-windowed sinc kernel
+StreamingResampler uses for the same ResamplerQuality, sampled at the exact phase offsets rather than
+a grid of them, and each is normalised to exactly unity gain at DC.
+
+Tables are immutable once built, and shared: every RationalResampler<Type> set up for the same L, M and
+quality, whatever its channel count, holds a shared_ptr to the same one, built the first time it is
+asked for and freed when the last user lets go. Building and looking one up takes a lock, so
+setRates() and setQuality() are for setup, not the audio thread. Called after prepare(), they re-size
+the history for the new kernel and reset, so there is no need to prepare() again.
+
+Like StreamingResampler, the state carries across process() calls, so converting a long file in chunks
+gives exactly the same output as converting it whole, the number of outputs per call varies from
+block to block, and process() doesn't allocate. The table has L rows, so this is meant for small L (a
+few hundred at most, as in the examples above); for arbitrary or drifting ratios use StreamingResampler.
+
+This class is wrapped in namespace IADSP even though it lives in IA_Utilities, like StreamingResampler.
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "ResamplerQuality.hpp"
+
+namespace IADSP
+{
+    template<typename Type>
+    class RationalResampler
+    {
+    public:
+        RationalResampler();
+
+        void reset() noexcept;
+
+        // e.g. setRates(44100, 48000); both must be positive
+        void setRates(int inputRate, int outputRate);
+        void setQuality(ResamplerQuality newQuality);
+        void prepare(int numChannels, int maximumInputBlockSize);
+
+        // the most output samples a process() call with numInputSamples can write, per channel
+        size_t getMaxOutputSamples(size_t numInputSamples) const noexcept;
+
+        // consumes numInputSamples from every channel and returns how many samples were written to each
+        // output channel (at most getMaxOutputSamples(numInputSamples))
+        size_t process(const Type* const* input, size_t numInputSamples, Type* const* output) noexcept;
+
+        // the reduced ratio: L output samples for every M input samples
+        int getUpsamplingFactor() const noexcept { return upFactor; }
+        int getDownsamplingFactor() const noexcept { return downFactor; }
+
+        // in input samples, with the same meaning as StreamingResampler::getLatency()
+        size_t getLatency() const noexcept { return table->kernelLength / 2; }
+
+    private:
+        // one row of kernelLength taps per output in the cycle, oldest-input-first, plus how many input
+        // samples the window moves on after that output
+        struct Table
+        {
+            std::vector<Type> coefficients;
+            std::vector<size_t> advance;
+            size_t kernelLength = 0;
+        };
+
+        // picks up the table for the current rates and quality, re-preparing if already prepared
+        void updateTable();
+
+        static std::shared_ptr<const Table> getTable(int upFactor, int downFactor, ResamplerQuality quality);
+        static std::shared_ptr<const Table> designTable(int upFactor, int downFactor, ResamplerQuality quality);
+
+        ResamplerQuality quality = ResamplerQuality::Normal;
+        int upFactor = 1;
+        int downFactor = 1;
+        std::shared_ptr<const Table> table;
+
+        // per channel: unconsumed input (at least the current window) followed by room for one block
+        std::vector<std::vector<Type>> history;
+        int numChannels = 0;
+        int maximumBlockSize = 0;
+
+        // shared by every channel: samples held in each history buffer, the start of the next output's
+        // window within it, and that output's row in the cycle
+        size_t numBuffered = 0;
+        size_t windowStart = 0;
+        size_t cyclePosition = 0;
+    };
+}
@@ -0,0 +1,211 @@
+#include "RealFFT.hpp"
+#include "VectorOps.hpp"
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace IADSP
+{
+    template<typename Type>
+    RealFFT<Type>::RealFFT(size_t newSize)
+    {
+        setSize(newSize);
+    }
+
+    template<typename Type>
+    void RealFFT<Type>::setSize(size_t newSize)
+    {
+        assert(newSize >= 2 && (newSize & (newSize - 1)) == 0);
+
+        size = newSize;
+        complexSize = size / 2;
+
+        size_t numBits = 0;
+        while((size_t { 1 } << numBits) < complexSize) {
+            ++numBits;
+        }
+
+        bitReversed.resize(complexSize);
+        for(size_t k = 0; k < complexSize; ++k)
+        {
+            size_t reversed = 0;
+            for(size_t bit = 0; bit < numBits; ++bit) {
+                reversed |= ((k >> bit) & 1) << (numBits - 1 - bit);
+            }
+            bitReversed[k] = reversed;
+        }
+
+        // stage twiddles e^(-2 pi i j / (2h)) for j in [0, h), for every half-length h
+        stageTwiddleRe.resize(complexSize > 1 ? complexSize - 1 : 0);
+        stageTwiddleIm.resize(stageTwiddleRe.size());
+        for(size_t half = 1; half < complexSize; half *= 2)
+        {
+            for(size_t j = 0; j < half; ++j)
+            {
+                const auto angle = -std::numbers::pi * static_cast<double>(j) / static_cast<double>(half);
+                stageTwiddleRe[half - 1 + j] = static_cast<Type>(std::cos(angle));
+                stageTwiddleIm[half - 1 + j] = static_cast<Type>(std::sin(angle));
+            }
+        }
+
+        splitTwiddleRe.resize(complexSize / 2 + 1);
+        splitTwiddleIm.resize(complexSize / 2 + 1);
+        for(size_t k = 0; k <= complexSize / 2; ++k)
+        {
+            const auto angle = -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(size);
+            splitTwiddleRe[k] = static_cast<Type>(std::cos(angle));
+            splitTwiddleIm[k] = static_cast<Type>(std::sin(angle));
+        }
+
+        workRe.assign(complexSize, static_cast<Type>(0.0));
+        workIm.assign(complexSize, static_cast<Type>(0.0));
+    }
+
+    template<typename Type>
+    void RealFFT<Type>::transformComplex() noexcept
+    {
+        auto* re = workRe.data();
+        auto* im = workIm.data();
+
+        // the first two stages' twiddles are only 1 and -i, so they run together as one multiply-free
+        // radix-4 pass (or a single radix-2 one if that's all there is)
+        if(complexSize == 2)
+        {
+            const auto tr = re[1], ti = im[1];
+            re[1] = re[0] - tr;
+            im[1] = im[0] - ti;
+            re[0] += tr;
+            im[0] += ti;
+        }
+        else if(complexSize >= 4)
+        {
+            for(size_t start = 0; start < complexSize; start += 4)
+            {
+                const auto ar = re[start] + re[start + 1], ai = im[start] + im[start + 1];
+                const auto br = re[start] - re[start + 1], bi = im[start] - im[start + 1];
+                const auto cr = re[start + 2] + re[start + 3], ci = im[start + 2] + im[start + 3];
+                const auto dr = re[start + 2] - re[start + 3], di = im[start + 2] - im[start + 3];
+
+                // d * -i = (di, -dr)
+                re[start] = ar + cr;        im[start] = ai + ci;
+                re[start + 2] = ar - cr;    im[start + 2] = ai - ci;
+                re[start + 1] = br + di;    im[start + 1] = bi - dr;
+                re[start + 3] = br - di;    im[start + 3] = bi + dr;
+            }
+        }
+
+        for(size_t half = 4; half < complexSize; half *= 2)
+        {
+            const auto* wr = stageTwiddleRe.data() + half - 1;
+            const auto* wi = stageTwiddleIm.data() + half - 1;
+
+            for(size_t start = 0; start < complexSize; start += 2 * half) {
+                VectorOps::complexButterflies(re + start, im + start, re + start + half, im + start + half, wr, wi, half);
+            }
+        }
+    }
+
+    template<typename Type>
+    void RealFFT<Type>::forward(const Type* input, std::complex<Type>* output) noexcept
+    {
+        const auto m = complexSize;
+        const auto half = static_cast<Type>(0.5);
+
+        // even samples into the real parts, odd into the imaginary; the whole input is read before any
+        // output is written, which is what makes the in-place version safe
+        for(size_t k = 0; k < m; ++k)
+        {
+            workRe[bitReversed[k]] = input[2 * k];
+            workIm[bitReversed[k]] = input[2 * k + 1];
+        }
+
+        transformComplex();
+
+        // Z[k] = E[k] + i O[k], where E and O are the spectra of the even and odd samples; both are
+        // conjugate-symmetric, so Z[k] and Z[m - k] between them give E[k] and O[k], and then
+        // X[k] = E[k] + W^k O[k] and X[m - k] = conj(E[k] - W^k O[k])
+        output[0] = { workRe[0] + workIm[0], static_cast<Type>(0.0) };
+        output[m] = { workRe[0] - workIm[0], static_cast<Type>(0.0) };
+
+        for(size_t k = 1; k <= m / 2; ++k)
+        {
+            const auto ar = workRe[k], ai = workIm[k];
+            const auto br = workRe[m - k], bi = -workIm[m - k];
+
+            const auto er = half * (ar + br), ei = half * (ai + bi);
+            const auto orr = half * (ai - bi), oi = -half * (ar - br);
+
+            const auto wr = splitTwiddleRe[k], wi = splitTwiddleIm[k];
+            const auto tr = wr * orr - wi * oi;
+            const auto ti = wr * oi + wi * orr;
+
+            output[k] = { er + tr, ei + ti };
+            if(k != m - k) {
+                output[m - k] = { er - tr, ti - ei };
+            }
+        }
+    }
+
+    template<typename Type>
+    void RealFFT<Type>::inverse(const std::complex<Type>* input, Type* output) noexcept
+    {
+        const auto m = complexSize;
+        const auto half = static_cast<Type>(0.5);
+        const auto scale = static_cast<Type>(1.0 / static_cast<double>(m));
+
+        // the reverse of forward()'s last step rebuilds Z, which then goes through the same forward
+        // complex FFT conjugated on the way in and out (an inverse FFT), with the 1 / m folded in here
+        {
+            const auto x0 = input[0].real(), xm = input[m].real();
+            workRe[bitReversed[0]] = scale * half * (x0 + xm);
+            workIm[bitReversed[0]] = -scale * half * (x0 - xm);
+        }
+
+        for(size_t k = 1; k <= m / 2; ++k)
+        {
+            const auto ar = input[k].real(), ai = input[k].imag();
+            const auto br = input[m - k].real(), bi = -input[m - k].imag();
+
+            const auto er = half * (ar + br), ei = half * (ai + bi);
+            const auto dr = half * (ar - br), di = half * (ai - bi);
+
+            // O = D * conj(W^k)
+            const auto wr = splitTwiddleRe[k], wi = splitTwiddleIm[k];
+            const auto orr = dr * wr + di * wi;
+            const auto oi = di * wr - dr * wi;
+
+            // Z[k] = E + i O and Z[m - k] = conj(E) + i conj(O), stored conjugated
+            workRe[bitReversed[k]] = scale * (er - oi);
+            workIm[bitReversed[k]] = -scale * (ei + orr);
+            if(k != m - k)
+            {
+                workRe[bitReversed[m - k]] = scale * (er + oi);
+                workIm[bitReversed[m - k]] = -scale * (orr - ei);
+            }
+        }
+
+        transformComplex();
+
+        for(size_t n = 0; n < m; ++n)
+        {
+            output[2 * n] = workRe[n];
+            output[2 * n + 1] = -workIm[n];
+        }
+    }
+
+    template<typename Type>
+    void RealFFT<Type>::forward(Type* data) noexcept
+    {
+        forward(data, reinterpret_cast<std::complex<Type>*>(data));
+    }
+
+    template<typename Type>
+    void RealFFT<Type>::inverse(Type* data) noexcept
+    {
+        inverse(reinterpret_cast<const std::complex<Type>*>(data), data);
+    }
+
+    //==============================================================================
+    template class RealFFT<float>;
+    template class RealFFT<double>;
+}
@@ -0,0 +1,82 @@
+/*
+This is a real-input FFT for power-of-two sizes, for analysers, convolvers and spectral effects that want
+a transform without pulling in juce::dsp::FFT or FFTW.
+
+    RealFFT<float> fft(1024);
+    fft.forward(samples, bins);         // 1024 reals in -> getNumBins() = 513 complex bins out
+    fft.inverse(bins, samples);         // and back
+
+forward() is the plain unnormalised DFT, X[k] = sum of x[n] * e^(-2 pi i k n / N), for bins 0 to N/2
+(the rest are the complex conjugates of these, since the input is real). inverse() includes the 1/N,
+so inverse(forward(x)) gives back x. The imaginary parts of bins 0 and N/2 are ignored by inverse().
+
+Each direction has an out-of-place version (separate real and std::complex<Type> buffers) and an
+in-place one, which works on a single buffer of getSize() + 2 Types: N real samples in, N/2 + 1
+interleaved (re, im) pairs out, or the other way round. std::complex<Type> has the same layout as a
+(re, im) pair of Types, so the in-place buffer can be read as std::complex<Type> bins.
+
+Internally a size-N real transform runs as a size-N/2 complex FFT over the even and odd samples packed
+into the real and imaginary parts, followed by one pass that separates the two halves of the spectrum.
+The complex FFT is an iterative radix-2 decimation in time over split real/imaginary arrays, so every
+stage is a run of butterflies on contiguous data with a contiguous run of twiddles - exactly the shape
+VectorOps::complexButterflies() vectorises. Twiddles and the bit-reversal permutation are precomputed
+into a plan by setSize() (or the sized constructor), which is the only method that allocates;
+forward() and inverse() are realtime-safe. They use working buffers held by the object, so one RealFFT
+can't be used from two threads at once - give each thread its own.
+
+Only power-of-two sizes are supported. Mixed-radix sizes aren't implemented; pad or window to a power
+of two instead.
+
+This class is wrapped in namespace IADSP even though it lives in IA_Utilities, like the resamplers.
+*/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cstddef>
+
+namespace IADSP
+{
+    template<typename Type>
+    class RealFFT
+    {
+    public:
+        RealFFT() = default;
+        explicit RealFFT(size_t size);
+
+        // size must be a power of two, 2 or more; builds the plan (allocates)
+        void setSize(size_t newSize);
+
+        size_t getSize() const noexcept { return size; }
+        size_t getNumBins() const noexcept { return size / 2 + 1; }
+
+        // getSize() reals in -> getNumBins() bins out
+        void forward(const Type* input, std::complex<Type>* output) noexcept;
+
+        // getNumBins() bins in -> getSize() reals out, scaled by 1 / getSize()
+        void inverse(const std::complex<Type>* input, Type* output) noexcept;
+
+        // in place, on a buffer of getSize() + 2 Types (see the top of this file)
+        void forward(Type* data) noexcept;
+        void inverse(Type* data) noexcept;
+
+    private:
+        // the size-N/2 complex FFT, in place on workRe/workIm, whose input is already in bit-reversed order
+        void transformComplex() noexcept;
+
+        size_t size = 0;
+        size_t complexSize = 0;
+
+        // for each input index, where it belongs in bit-reversed order
+        std::vector<size_t> bitReversed;
+
+        // stage by stage: the stage with half-length h has its h twiddles starting at index h - 1
+        std::vector<Type> stageTwiddleRe, stageTwiddleIm;
+
+        // e^(-2 pi i k / N) for k in [0, N/4], used to separate the even and odd halves
+        std::vector<Type> splitTwiddleRe, splitTwiddleIm;
+
+        std::vector<Type> workRe, workIm;
+    };
+}
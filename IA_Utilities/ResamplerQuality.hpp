@@ -0,0 +1,79 @@
+/*
+Quality presets shared by the resamplers (StreamingResampler and RationalResampler), so the same setting
+buys the same filter from either one. Each preset is a Kaiser-windowed sinc kernel, described by its
+length when upsampling (downsampling stretches it by the ratio) and its stopband attenuation:
+    Draft  - 16 taps,  60dB stopband, passband to ~0.55 of Nyquist
+    Normal - 64 taps, 100dB stopband, passband to ~0.80 of Nyquist (the default)
+    High   - 128 taps, 130dB stopband, passband to ~0.87 of Nyquist
+In every case the stopband starts at the lower of the input and output Nyquist frequencies, so nothing
+above it aliases back down by more than the stopband level.
+
+resamplerKernel() evaluates the kernel at any point, in input samples from its centre. The resamplers
+sample it into their coefficient tables up front, so none of this runs per sample.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include "../IA_Filters/FIRDesign.hpp"
+
+namespace IADSP
+{
+    enum struct ResamplerQuality
+    {
+        Draft,
+        Normal,
+        High
+    };
+
+    struct ResamplerKernelShape
+    {
+        int zeroCrossings = 32;         // per side of the kernel, when upsampling
+        double attenuationDB = 100.0;
+        int numPhases = 512;            // StreamingResampler's table resolution, when upsampling
+
+        // set by forRatio() for a given input-to-output ratio
+        int length = 64;
+        double cutoff = 1.0;            // as a fraction of the input Nyquist
+        double beta = 0.0;
+
+        static ResamplerKernelShape forRatio(ResamplerQuality quality, double inToOutRatio)
+        {
+            ResamplerKernelShape shape;
+            switch(quality)
+            {
+                case ResamplerQuality::Draft:   shape.zeroCrossings = 8;  shape.attenuationDB = 60.0;  shape.numPhases = 256;  break;
+                case ResamplerQuality::High:    shape.zeroCrossings = 64; shape.attenuationDB = 130.0; shape.numPhases = 1024; break;
+                case ResamplerQuality::Normal:
+                default:                        break;
+            }
+
+            // stretch the kernel when downsampling so the cutoff follows the output Nyquist
+            const auto scale = std::min(1.0, 1.0 / inToOutRatio);
+            shape.length = 2 * static_cast<int>(std::ceil(shape.zeroCrossings / scale));
+
+            // Kaiser's length estimate, solved for the transition width this length buys (as a fraction
+            // of the input Nyquist), then the cutoff placed so the stopband starts at the lower Nyquist
+            const auto transition = (shape.attenuationDB - 7.95) / (14.36 * 0.5 * shape.length);
+            shape.cutoff = scale - 0.5 * transition;
+            shape.beta = FIRDesign::kaiserBeta(shape.attenuationDB);
+            return shape;
+        }
+    };
+
+    // the windowed sinc at x input samples from its centre (zero outside +/- length / 2), not normalised
+    inline double resamplerKernel(const ResamplerKernelShape& shape, double x)
+    {
+        const auto halfLength = 0.5 * shape.length;
+        const auto r = x / halfLength;
+        if(r <= -1.0 || r >= 1.0) {
+            return 0.0;
+        }
+
+        const auto t = std::numbers::pi * shape.cutoff * x;
+        const auto sinc = (x == 0.0) ? 1.0 : std::sin(t) / t;
+        return shape.cutoff * sinc * FIRDesign::kaiserWindow(r, shape.beta);
+    }
+}
@@ -3,6 +3,11 @@ This class will take a buffer and do some lightweight processing to resample it
 It can run in realtime, however it is up to you to manage the buffers used.
 A basic use for this class would be to convert a file at one sample rate for streaming at another.
 In my case I use it to downsample buffers for FFT displays if the sample rate is very high (over 48kHz)
+
+Note that each processChannel() call is self-contained: the read position starts again from zero and the
+interpolation only sees that call's input, so consecutive blocks don't join up seamlessly. For streaming
+a signal through in chunks (or anything where quality matters) use IADSP::StreamingResampler instead, or
+IADSP::RationalResampler for fixed ratios like 44.1kHz <-> 48kHz.
 */
 
 #pragma once
@@ -0,0 +1,124 @@
+/*
+A wait-free triple buffer for handing a small struct of values from the audio thread to a GUI thread, e.g.
+a meter's loudness and peak levels: once per block the audio thread publishes the whole struct, and the
+GUI reads the latest one at whatever rate it redraws, always getting a consistent set of fields - never
+half of one block's values and half of the next - without an atomic per field.
+
+    // audio thread, once per block
+    auto& snapshot = publisher.getWriteBuffer();
+    snapshot.loudness = ...;
+    snapshot.peak = ...;
+    publisher.publish();
+
+    // GUI thread
+    const auto& latest = publisher.read();
+
+There are three copies of T: one the producer writes into, one the consumer reads from, and a middle one
+holding the latest published snapshot. publish() swaps the producer's copy with the middle one, and
+read() swaps the middle one with the consumer's if something new has been published since, each with a
+single atomic exchange on a byte holding the middle copy's index and a "new" flag. Neither side ever
+waits for the other or retries, so the audio thread's cost is one exchange per publish() whatever the
+GUI is doing. A snapshot published while the previous one is still unread simply replaces it - only
+the latest matters - and a read() with nothing new keeps returning the snapshot it returned last time.
+
+T must be trivially copyable, and should be small: it is copied by the producer, not by read(), but three
+of it are kept. Each copy gets its own cache line(s), so the two threads don't contend on them.
+
+One thread may call getWriteBuffer()/publish(); one other may call hasNewSnapshot()/read(). The
+reference read() returns stays valid, and unchanged, until that thread's next read(). getWriteBuffer()
+starts out as a copy of whatever was in that slot before, not the last published snapshot, so fill in
+every field. reset() is for setup only.
+
+SnapshotPublisher is neither copyable nor movable (std::atomic member).
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "CacheLine.hpp"
+
+template<typename T>
+class SnapshotPublisher
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "SnapshotPublisher copies T between threads as raw memory");
+
+    SnapshotPublisher()
+    {
+        reset();
+    }
+
+    explicit SnapshotPublisher(const T& initialValue)
+    {
+        reset(initialValue);
+    }
+
+    // sets all three copies to initialValue, with nothing new to read
+    void reset(const T& initialValue = T {}) noexcept
+    {
+        for(auto& slot : slots) {
+            slot.value = initialValue;
+        }
+
+        writeIndex = 0;
+        middle.store(1);
+        readIndex = 2;
+    }
+
+    // producer: the copy to fill in before the next publish()
+    T& getWriteBuffer() noexcept
+    {
+        return slots[writeIndex].value;
+    }
+
+    // producer: makes the write buffer the latest snapshot, and hands back another one to write into
+    void publish() noexcept
+    {
+        // release, so the consumer's acquire in read() sees everything written to the slot; acquire, so
+        // the slot handed back here is one the consumer has finished reading
+        const auto previous = middle.exchange(static_cast<uint8_t>(writeIndex | newFlag), std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    void publish(const T& snapshot) noexcept
+    {
+        getWriteBuffer() = snapshot;
+        publish();
+    }
+
+    // consumer: whether a snapshot has been published since the last read()
+    bool hasNewSnapshot() const noexcept
+    {
+        return (middle.load(std::memory_order_relaxed) & newFlag) != 0;
+    }
+
+    // consumer: the latest published snapshot
+    const T& read() noexcept
+    {
+        if(hasNewSnapshot())
+        {
+            const auto previous = middle.exchange(static_cast<uint8_t>(readIndex), std::memory_order_acq_rel);
+            readIndex = previous & indexMask;
+        }
+
+        return slots[readIndex].value;
+    }
+
+private:
+    static constexpr uint8_t indexMask = 3, newFlag = 4;
+
+    struct alignas(IADSP::cacheLineSize) Slot
+    {
+        T value;
+    };
+
+    Slot slots[3];
+
+    // the middle slot's index, plus newFlag when it holds a snapshot the consumer hasn't taken yet
+    alignas(IADSP::cacheLineSize) std::atomic<uint8_t> middle {1};
+    int writeIndex = 0;
+
+    alignas(IADSP::cacheLineSize) int readIndex = 2;
+};
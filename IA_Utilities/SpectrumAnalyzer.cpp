@@ -0,0 +1,222 @@
+#include "SpectrumAnalyzer.hpp"
+#include "Decibels.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace IADSP
+{
+    namespace
+    {
+        // the most update() takes from the Fifo at a time
+        constexpr int readBlockSize = 4096;
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::setFFTSize(int newFFTSize)
+    {
+        assert(newFFTSize >= 16 && (newFFTSize & (newFFTSize - 1)) == 0);
+        fftSize = newFFTSize;
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::setNumOutputBins(int newNumOutputBins)
+    {
+        assert(newNumOutputBins > 0);
+        numOutputBins = std::max(1, newNumOutputBins);
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::setFrequencyRange(double newMinFrequency, double newMaxFrequency)
+    {
+        assert(newMinFrequency > 0.0 && newMaxFrequency > newMinFrequency);
+        minFrequency = newMinFrequency;
+        maxFrequency = newMaxFrequency;
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::prepare(double newSampleRate, int maximumBlockSize)
+    {
+        sampleRate = newSampleRate;
+
+        // the High quality decimator passes up to ~0.87 of its output Nyquist, so keep the top of the
+        // display under that
+        decimationFactor = std::max(1, static_cast<int>(sampleRate / (2.3 * maxFrequency)));
+        decimator.setQuality(ResamplerQuality::High);
+        decimator.setRates(decimationFactor, 1);
+        decimator.prepare(1, readBlockSize);
+
+        fifo.setSize(static_cast<int>(std::ceil(0.25 * sampleRate)) + maximumBlockSize + 1);
+        decimatedBuffer.assign(decimator.getMaxOutputSamples(readBlockSize), static_cast<Type>(0.0));
+
+        const auto size = static_cast<size_t>(fftSize);
+        fft.setSize(size);
+        history.assign(size, static_cast<Type>(0.0));
+        windowed.assign(size, static_cast<Type>(0.0));
+        bins.assign(fft.getNumBins(), {});
+        power.assign(fft.getNumBins(), static_cast<Type>(0.0));
+
+        // periodic Hann, whose coefficients sum to exactly half the size
+        window.resize(size);
+        for(size_t n = 0; n < size; ++n) {
+            window[n] = static_cast<Type>(0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(n) / static_cast<double>(size)));
+        }
+        const auto peakScale = 2.0 / (0.5 * static_cast<double>(size));
+        powerScale = static_cast<Type>(peakScale * peakScale);
+
+        // output bins are spaced evenly in log frequency between minFrequency and maxFrequency (capped at
+        // the analysis Nyquist)
+        const auto binWidth = getAnalysisSampleRate() / static_cast<double>(fftSize);
+        const auto lastBin = static_cast<int>(fft.getNumBins()) - 1;
+        const auto top = std::min(maxFrequency, 0.5 * getAnalysisSampleRate());
+        const auto ratio = top / minFrequency;
+
+        bands.resize(numOutputBins);
+        for(int i = 0; i < numOutputBins; ++i)
+        {
+            const auto low = minFrequency * std::pow(ratio, static_cast<double>(i) / numOutputBins) / binWidth;
+            const auto high = minFrequency * std::pow(ratio, static_cast<double>(i + 1) / numOutputBins) / binWidth;
+
+            auto& band = bands[i];
+            band.first = std::min(static_cast<int>(std::ceil(low)), lastBin);
+            band.last = std::min(static_cast<int>(std::ceil(high)) - 1, lastBin);
+
+            if(band.last < band.first)
+            {
+                const auto centre = std::sqrt(low * high);
+                band.first = std::min(static_cast<int>(centre), lastBin - 1);
+                band.fraction = static_cast<Type>(std::min(centre - band.first, 1.0));
+            }
+        }
+
+        spectrum.resize(numOutputBins);
+        reset();
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::reset() noexcept
+    {
+        fifo.reset();
+        decimator.reset();
+        std::fill(history.begin(), history.end(), static_cast<Type>(0.0));
+        std::fill(spectrum.begin(), spectrum.end(), Decibels::fromGain(static_cast<Type>(0.0)));
+        samplesSinceFrame = 0;
+    }
+
+    template<typename Type>
+    double SpectrumAnalyzer<Type>::getOutputBinFrequency(int i) const noexcept
+    {
+        const auto top = std::min(maxFrequency, 0.5 * getAnalysisSampleRate());
+        return minFrequency * std::pow(top / minFrequency, (static_cast<double>(i) + 0.5) / numOutputBins);
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::pushSamples(const Type* samples, int numSamples) noexcept
+    {
+        fifo.addToFifo(samples, numSamples);
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::pushSamples(const AudioBuffer<Type>& buffer) noexcept
+    {
+        fifo.addToFifo(buffer);
+    }
+
+    template<typename Type>
+    bool SpectrumAnalyzer<Type>::update() noexcept
+    {
+        // only what is there now, so a producer that keeps up can't keep this busy forever
+        auto remaining = fifo.getSizeToRead();
+
+        while(remaining > 0)
+        {
+            // straight out of the Fifo's ring, without copying it out first
+            const auto regions = fifo.acquireRead(std::min(remaining, readBlockSize));
+
+            for(const auto region : { regions.first, regions.second })
+            {
+                if(region.empty()) {
+                    continue;
+                }
+
+                if(decimationFactor == 1) {
+                    appendToHistory(region.data(), region.size());
+                }
+                else
+                {
+                    const Type* input[] = { region.data() };
+                    Type* output[] = { decimatedBuffer.data() };
+                    const auto numDecimated = decimator.process(input, region.size(), output);
+                    appendToHistory(decimatedBuffer.data(), numDecimated);
+                }
+            }
+
+            fifo.commitRead(static_cast<int>(regions.size()));
+            remaining -= static_cast<int>(regions.size());
+        }
+
+        if(samplesSinceFrame < static_cast<size_t>(fftSize / 4)) {
+            return false;
+        }
+
+        analyseFrame();
+        samplesSinceFrame = 0;
+        return true;
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::appendToHistory(const Type* samples, size_t numSamples) noexcept
+    {
+        const auto size = history.size();
+        samplesSinceFrame += numSamples;
+
+        if(numSamples >= size) {
+            std::copy(samples + numSamples - size, samples + numSamples, history.begin());
+        }
+        else
+        {
+            std::copy(history.begin() + numSamples, history.end(), history.begin());
+            std::copy(samples, samples + numSamples, history.end() - numSamples);
+        }
+    }
+
+    template<typename Type>
+    void SpectrumAnalyzer<Type>::analyseFrame() noexcept
+    {
+        const auto size = history.size();
+        for(size_t n = 0; n < size; ++n) {
+            windowed[n] = history[n] * window[n];
+        }
+
+        fft.forward(windowed.data(), bins.data());
+
+        // on the interleaved parts directly, which the compiler can vectorise
+        const auto* interleaved = reinterpret_cast<const Type*>(bins.data());
+        for(size_t k = 0; k < power.size(); ++k)
+        {
+            const auto re = interleaved[2 * k], im = interleaved[2 * k + 1];
+            power[k] = powerScale * (re * re + im * im);
+        }
+
+        // only one log per output bin, on the band's peak power
+        for(int i = 0; i < numOutputBins; ++i)
+        {
+            const auto& band = bands[i];
+            Type value;
+
+            if(band.last >= band.first) {
+                value = *std::max_element(power.begin() + band.first, power.begin() + band.last + 1);
+            }
+            else {
+                value = power[band.first] + band.fraction * (power[band.first + 1] - power[band.first]);
+            }
+
+            spectrum[i] = Decibels::fromGain(std::sqrt(value));
+        }
+    }
+
+    //==============================================================================
+    template class SpectrumAnalyzer<float>;
+    template class SpectrumAnalyzer<double>;
+}
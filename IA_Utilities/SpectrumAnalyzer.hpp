@@ -0,0 +1,118 @@
+/*
+This is the whole pipeline behind a spectrum display: the audio thread hands it samples, and a consumer
+thread (usually a GUI timer) gets back a fixed-size array of levels in dB on a log frequency axis,
+ready to draw.
+
+    analyzer.setFFTSize(4096);
+    analyzer.setNumOutputBins(512);
+    analyzer.prepare(sampleRate, maximumBlockSize);
+
+    analyzer.pushSamples(buffer[0], numSamples);        // audio thread - a copy into a Fifo, nothing else
+
+    if(analyzer.update()) {                             // consumer thread
+        draw(analyzer.getSpectrum());                   // getNumOutputBins() dB values, lowest frequency first
+    }
+
+The audio thread side is a plain Fifo (IA_Utilities/FiFo.hpp), so pushSamples() is just a copy into a
+ring buffer, and the AudioBuffer overload averages the channels down to mono on the way in (Fifo's own
+addToFifo()). If the consumer falls behind, samples that don't fit are dropped rather than blocking;
+the Fifo holds a quarter of a second, plus a block.
+
+Everything else happens in update(), on the consumer thread. It drains the Fifo in place, through
+acquireRead(), decimates by a whole factor when the sample rate is well above what the frequency range
+needs (192kHz down to 48kHz for a 20kHz display, say) through a RationalResampler, and keeps the latest
+FFT-size worth of samples. Once at least a quarter of an FFT's worth of new samples has arrived it runs
+one frame: Hann window, RealFFT, power per FFT bin, then each output bin takes the loudest FFT bin in
+its frequency band - or, at the low end where output bins are narrower than FFT bins, the power
+interpolated at its centre frequency - and converts it to dB. Only the newest frame is analysed however
+much has arrived since the last update(), so a display that redraws slowly does no wasted work. The
+levels are scaled so that a full-scale sine reads 0dB.
+
+The window, the decimator, the band edges of every output bin and every buffer are set up in prepare(),
+which allocates; pushSamples() and update() don't. The setters take effect at the next prepare().
+pushSamples() may only be called from one thread, and update() and getSpectrum() from one other.
+
+This class is wrapped in namespace IADSP even though it lives in IA_Utilities, like RealFFT.
+*/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <span>
+#include "FiFo.hpp"
+#include "RealFFT.hpp"
+#include "RationalResampler.hpp"
+#include "AudioBuffer.hpp"
+
+namespace IADSP
+{
+    template<typename Type>
+    class SpectrumAnalyzer
+    {
+    public:
+        SpectrumAnalyzer() = default;
+
+        // a power of two, 2048 by default
+        void setFFTSize(int newFFTSize);
+        void setNumOutputBins(int newNumOutputBins);
+        void setFrequencyRange(double newMinFrequency, double newMaxFrequency);
+
+        void prepare(double newSampleRate, int maximumBlockSize);
+
+        // clears everything analysed so far; not to be called while either thread is using the analyzer
+        void reset() noexcept;
+
+        // audio thread
+        void pushSamples(const Type* samples, int numSamples) noexcept;
+        void pushSamples(const AudioBuffer<Type>& buffer) noexcept;
+
+        // consumer thread: returns true if getSpectrum() has been updated
+        bool update() noexcept;
+        std::span<const Type> getSpectrum() const noexcept { return spectrum; }
+
+        int getNumOutputBins() const noexcept { return numOutputBins; }
+
+        // the centre frequency of output bin i, in Hz
+        double getOutputBinFrequency(int i) const noexcept;
+
+        // the rate the FFT actually runs at, after decimation
+        double getAnalysisSampleRate() const noexcept { return sampleRate / static_cast<double>(decimationFactor); }
+
+    private:
+        // output bin i is the loudest of FFT bins [first, last], or if there are none (last < first), the
+        // power interpolated at fractional bin position first + fraction
+        struct OutputBand
+        {
+            int first = 0, last = 0;
+            Type fraction = static_cast<Type>(0.0);
+        };
+
+        // appends samples to the end of history, dropping the oldest
+        void appendToHistory(const Type* samples, size_t numSamples) noexcept;
+        void analyseFrame() noexcept;
+
+        int fftSize = 2048;
+        int numOutputBins = 512;
+        double minFrequency = 20.0, maxFrequency = 20000.0;
+
+        double sampleRate = 48000.0;
+        int decimationFactor = 1;
+
+        Fifo<Type> fifo;
+        RationalResampler<Type> decimator;
+        RealFFT<Type> fft;
+
+        // the decimator's output for one region of the Fifo
+        std::vector<Type> decimatedBuffer;
+
+        std::vector<Type> history, window, windowed, power;
+        std::vector<std::complex<Type>> bins;
+        std::vector<OutputBand> bands;
+        std::vector<Type> spectrum;
+
+        // scales power so a full-scale sine's peak bin comes out at 1
+        Type powerScale = static_cast<Type>(1.0);
+        size_t samplesSinceFrame = 0;
+    };
+}
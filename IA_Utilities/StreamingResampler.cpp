@@ -0,0 +1,154 @@
+#include "StreamingResampler.hpp"
+#include "VectorOps.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace IADSP
+{
+    template<typename Type>
+    StreamingResampler<Type>::StreamingResampler()
+    {
+        designTable();
+    }
+
+    template<typename Type>
+    void StreamingResampler<Type>::setQuality(ResamplerQuality newQuality)
+    {
+        quality = newQuality;
+        designTable();
+    }
+
+    template<typename Type>
+    void StreamingResampler<Type>::setResamplingRatio(double newInToOutRatio)
+    {
+        assert(newInToOutRatio > 0.0);
+        ratio = newInToOutRatio > 0.0 ? newInToOutRatio : 1.0;
+        designTable();
+    }
+
+    template<typename Type>
+    void StreamingResampler<Type>::designTable()
+    {
+        const auto shape = ResamplerKernelShape::forRatio(quality, ratio);
+
+        // the stretched kernel of a downsampler is smoother, so it needs proportionally fewer phases
+        kernelLength = static_cast<size_t>(shape.length);
+        numPhases = static_cast<size_t>(std::max(16.0, std::ceil(shape.numPhases * std::min(1.0, 1.0 / ratio))));
+        const auto halfLength = 0.5 * static_cast<double>(kernelLength);
+
+        table.resize((numPhases + 1) * kernelLength);
+        std::vector<double> row(kernelLength);
+
+        for(size_t p = 0; p <= numPhases; ++p)
+        {
+            // tap k is applied to the input sample (halfLength - 1 - k + offset) samples before the
+            // output's position
+            const auto offset = static_cast<double>(p) / static_cast<double>(numPhases);
+            double sum = 0.0;
+
+            for(size_t k = 0; k < kernelLength; ++k)
+            {
+                row[k] = resamplerKernel(shape, offset + halfLength - 1.0 - static_cast<double>(k));
+                sum += row[k];
+            }
+
+            auto* destination = table.data() + p * kernelLength;
+            for(size_t k = 0; k < kernelLength; ++k) {
+                destination[k] = static_cast<Type>(row[k] / sum);
+            }
+        }
+    }
+
+    template<typename Type>
+    void StreamingResampler<Type>::prepare(int newNumChannels, int newMaximumBlockSize)
+    {
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+
+        // what's left after a call is always less than one window
+        history.assign(numChannels, std::vector<Type>(kernelLength + maximumBlockSize, static_cast<Type>(0.0)));
+        reset();
+    }
+
+    template<typename Type>
+    void StreamingResampler<Type>::reset() noexcept
+    {
+        for(auto& h : history) {
+            std::fill(h.begin(), h.end(), static_cast<Type>(0.0));
+        }
+
+        // start with the first output centred on the first input sample, preceded by silence
+        numBuffered = kernelLength / 2 - 1;
+        windowStart = 0;
+        fraction = 0.0;
+    }
+
+    template<typename Type>
+    size_t StreamingResampler<Type>::getMaxOutputSamples(size_t numInputSamples) const noexcept
+    {
+        // the previous call left its next window less than one sample short of the end of the input,
+        // so this one can advance by at most numInputSamples + 1
+        return static_cast<size_t>(std::ceil(static_cast<double>(numInputSamples + 1) / ratio));
+    }
+
+    template<typename Type>
+    size_t StreamingResampler<Type>::process(const Type* const* input, size_t numInputSamples, Type* const* output) noexcept
+    {
+        assert(numInputSamples <= static_cast<size_t>(maximumBlockSize));
+
+        const auto available = numBuffered + numInputSamples;
+        const auto phaseScale = static_cast<double>(numPhases);
+        size_t numOutput = 0;
+        size_t nextWindowStart = windowStart;
+        double nextFraction = fraction;
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            auto* buffer = history[c].data();
+            std::copy(input[c], input[c] + numInputSamples, buffer + numBuffered);
+
+            // every channel replays the same sequence of positions from the shared starting point
+            auto start = windowStart;
+            auto frac = fraction;
+            auto* out = output[c];
+            numOutput = 0;
+
+            while(start + kernelLength <= available)
+            {
+                const auto phase = frac * phaseScale;
+                const auto row = static_cast<size_t>(phase);
+                const auto blend = static_cast<Type>(phase - static_cast<double>(row));
+                const auto* lower = table.data() + row * kernelLength;
+
+                const auto a = VectorOps::dotProduct(lower, buffer + start, kernelLength);
+                const auto b = VectorOps::dotProduct(lower + kernelLength, buffer + start, kernelLength);
+                out[numOutput++] = a + blend * (b - a);
+
+                frac += ratio;
+                const auto whole = std::floor(frac);
+                start += static_cast<size_t>(whole);
+                frac -= whole;
+            }
+
+            nextWindowStart = start;
+            nextFraction = frac;
+        }
+
+        // slide whatever the next window still needs down to the front; a window start beyond the
+        // buffered input (only possible when the ratio exceeds the kernel length) carries over as a skip
+        const auto consumed = std::min(nextWindowStart, available);
+        for(auto& h : history) {
+            std::copy(h.begin() + consumed, h.begin() + available, h.begin());
+        }
+
+        numBuffered = available - consumed;
+        windowStart = nextWindowStart - consumed;
+        fraction = nextFraction;
+        return numOutput;
+    }
+
+    //==============================================================================
+    template class StreamingResampler<float>;
+    template class StreamingResampler<double>;
+}
@@ -0,0 +1,95 @@
+/*
+This is a stateful, arbitrary-ratio resampler for streams that arrive a block at a time - converting a
+long file in fixed-size chunks, or a live input at one rate into a processing graph running at another.
+Unlike ResamplingFilter, which starts from scratch every call, it carries both its input history and its
+fractional read position from one process() call to the next, so chunked output is sample-for-sample
+the same as converting the whole signal in one go - no seams at block boundaries.
+
+    resampler.setQuality(ResamplerQuality::Normal);
+    resampler.setResamplingRatio(44100.0 / 48000.0);    // input samples per output sample
+    resampler.prepare(numChannels, maximumInputBlockSize);
+    auto numOut = resampler.process(input, numIn, output); // output needs getMaxOutputSamples(numIn)
+
+The number of output samples per call varies from block to block (e.g. 44.1k -> 48k turns 512 input
+samples into 557 or 558 outputs), so process() returns how many it wrote. Every channel shares the same
+read position, so all of them produce the same count.
+
+Each output sample is a windowed-sinc (Kaiser) interpolation of the input around its exact fractional
+position. The kernel is precomputed into a polyphase table of numPhases + 1 rows, one for each evenly
+spaced fractional offset; an output is the dot product of the two rows either side of its offset with
+the input window, linearly interpolated between the two. That replaces the per-tap sin() and Bessel
+calls of a directly evaluated sinc with two table-driven dot products (through
+IA_Utilities/VectorOps.hpp), while the row spacing keeps the interpolation error below the stopband.
+Each row is normalised to exactly unity gain at DC.
+
+When downsampling (ratio > 1), the kernel is stretched by the ratio so that its cutoff follows the
+output Nyquist, which makes it proportionally longer; the number of phases shrinks by the same factor,
+since the stretched kernel is smoother, so the table stays roughly the same size.
+
+Quality presets (see ResamplerQuality.hpp) trade kernel length for passband width and stopband depth.
+
+The table and history buffers are allocated by setResamplingRatio()/setQuality() and prepare(); call
+prepare() again after changing either. process() doesn't allocate and is realtime-safe.
+
+This class is wrapped in namespace IADSP even though it lives in IA_Utilities, like Oversampler, since it
+is built on the FIR design helpers in IA_Filters.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "ResamplerQuality.hpp"
+
+namespace IADSP
+{
+    template<typename Type>
+    class StreamingResampler
+    {
+    public:
+        StreamingResampler();
+
+        void reset() noexcept;
+        void setQuality(ResamplerQuality newQuality);
+
+        // input samples per output sample (so inputRate / outputRate); must be greater than zero
+        void setResamplingRatio(double newInToOutRatio);
+        void prepare(int numChannels, int maximumInputBlockSize);
+
+        // the most output samples a process() call with numInputSamples can write, per channel
+        size_t getMaxOutputSamples(size_t numInputSamples) const noexcept;
+
+        // consumes numInputSamples from every channel and returns how many samples were written to each
+        // output channel (at most getMaxOutputSamples(numInputSamples))
+        size_t process(const Type* const* input, size_t numInputSamples, Type* const* output) noexcept;
+
+        // output n is the input interpolated at position n * ratio (the first output lines up with the
+        // first input sample); it comes out once the input has reached getLatency() samples past that
+        // position. In input samples: half the kernel length, e.g. 32 for Normal quality when upsampling
+        size_t getLatency() const noexcept { return kernelLength / 2; }
+        double getResamplingRatio() const noexcept { return ratio; }
+
+    private:
+        void designTable();
+
+        ResamplerQuality quality = ResamplerQuality::Normal;
+        double ratio = 1.0;
+
+        // kernelLength taps per row, numPhases + 1 rows: row p is the kernel for a fractional offset of
+        // p / numPhases, stored oldest-input-first to match the history layout
+        std::vector<Type> table;
+        size_t kernelLength = 0;
+        size_t numPhases = 0;
+
+        // per channel: unconsumed input (at least the current window) followed by room for one block
+        std::vector<std::vector<Type>> history;
+        int numChannels = 0;
+        int maximumBlockSize = 0;
+
+        // shared by every channel: samples held in each history buffer, and the start of the next
+        // output's window within it plus its fractional offset in [0, 1)
+        size_t numBuffered = 0;
+        size_t windowStart = 0;
+        double fraction = 0.0;
+    };
+}
@@ -0,0 +1,467 @@
+/*
+Small, header-only SIMD kernels shared by the filters and utilities that have a hot inner loop worth
+vectorizing by hand (FIR dot products, multiply-accumulates across channel lanes, etc).
+
+The instruction set is picked at compile time from the compiler's own target macros - there is no
+runtime dispatch. AVX2 is used when the translation unit is built with it enabled (e.g. -mavx2 or
+/arch:AVX2), otherwise SSE2 on any x86-64 target, NEON on ARM (double lanes only on AArch64), and a
+plain scalar loop everywhere else. Define IADSP_DISABLE_SIMD to force the scalar reference loops, which
+is handy for checking a vectorized path against them.
+
+All kernels accept unaligned pointers and any length; the vector loops handle the bulk and a scalar
+loop handles whatever is left over.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#if ! defined(IADSP_DISABLE_SIMD)
+    #if defined(__AVX2__)
+        #define IADSP_VECTOROPS_AVX2 1
+        #include <immintrin.h>
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define IADSP_VECTOROPS_SSE2 1
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+        #define IADSP_VECTOROPS_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+namespace IADSP
+{
+    namespace VectorOps
+    {
+        // Width in bytes of the registers the kernels below are built for - useful for padding
+        // interleaved data out to a whole number of registers.
+#if defined(IADSP_VECTOROPS_AVX2)
+        inline constexpr size_t registerBytes = 32;
+#elif defined(IADSP_VECTOROPS_SSE2) || defined(IADSP_VECTOROPS_NEON)
+        inline constexpr size_t registerBytes = 16;
+#else
+        inline constexpr size_t registerBytes = sizeof(double);
+#endif
+
+        // Returns the sum of a[i] * b[i] for i in [0, n), accumulated in float lanes.
+        inline float dotProduct(const float* a, const float* b, size_t n) noexcept
+        {
+            size_t i = 0;
+            float result = 0.0f;
+
+#if defined(IADSP_VECTOROPS_AVX2)
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            for(; i + 16 <= n; i += 16)
+            {
+                #if defined(__FMA__)
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+                #else
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+                acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+                #endif
+            }
+            for(; i + 8 <= n; i += 8) {
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            }
+            acc0 = _mm256_add_ps(acc0, acc1);
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+            result = _mm_cvtss_f32(sum);
+#elif defined(IADSP_VECTOROPS_SSE2)
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            for(; i + 8 <= n; i += 8)
+            {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+            }
+            for(; i + 4 <= n; i += 4) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            }
+            __m128 sum = _mm_add_ps(acc0, acc1);
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+            result = _mm_cvtss_f32(sum);
+#elif defined(IADSP_VECTOROPS_NEON)
+            float32x4_t acc0 = vdupq_n_f32(0.0f);
+            float32x4_t acc1 = vdupq_n_f32(0.0f);
+            for(; i + 8 <= n; i += 8)
+            {
+                acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+                acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            }
+            for(; i + 4 <= n; i += 4) {
+                acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            }
+            const float32x4_t sum = vaddq_f32(acc0, acc1);
+            const float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+            result = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+
+            for(; i < n; ++i) {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        // Returns the sum of a[i] * b[i] for i in [0, n), accumulated in double lanes.
+        inline double dotProduct(const double* a, const double* b, size_t n) noexcept
+        {
+            size_t i = 0;
+            double result = 0.0;
+
+#if defined(IADSP_VECTOROPS_AVX2)
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+            for(; i + 8 <= n; i += 8)
+            {
+                #if defined(__FMA__)
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+                acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+                #else
+                acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+                #endif
+            }
+            for(; i + 4 <= n; i += 4) {
+                acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+            }
+            acc0 = _mm256_add_pd(acc0, acc1);
+            __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+            sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+            result = _mm_cvtsd_f64(sum);
+#elif defined(IADSP_VECTOROPS_SSE2)
+            __m128d acc0 = _mm_setzero_pd();
+            __m128d acc1 = _mm_setzero_pd();
+            for(; i + 4 <= n; i += 4)
+            {
+                acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+            }
+            for(; i + 2 <= n; i += 2) {
+                acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            }
+            __m128d sum = _mm_add_pd(acc0, acc1);
+            sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+            result = _mm_cvtsd_f64(sum);
+#elif defined(IADSP_VECTOROPS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+            float64x2_t acc0 = vdupq_n_f64(0.0);
+            float64x2_t acc1 = vdupq_n_f64(0.0);
+            for(; i + 4 <= n; i += 4)
+            {
+                acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+                acc1 = vfmaq_f64(acc1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+            }
+            for(; i + 2 <= n; i += 2) {
+                acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+            }
+            result = vaddvq_f64(vaddq_f64(acc0, acc1));
+#endif
+
+            for(; i < n; ++i) {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        // result[c] = sum of weights[j] * frames[j * stride + c] over j in [0, numFrames), for every c in
+        // [0, stride) - i.e. a dot product down each lane of a run of interleaved frames. Lanes are
+        // processed two registers at a time so each weight is broadcast once per pair and the running
+        // sums stay in registers for the whole pass. stride must be a multiple of the register width.
+        inline void weightedFrameSum(float* result, const float* frames, const float* weights, size_t numFrames, size_t stride) noexcept
+        {
+            size_t c = 0;
+
+#if defined(IADSP_VECTOROPS_AVX2)
+            for(; c + 16 <= stride; c += 16)
+            {
+                __m256 acc0 = _mm256_setzero_ps();
+                __m256 acc1 = _mm256_setzero_ps();
+                for(size_t j = 0; j < numFrames; ++j)
+                {
+                    const __m256 w = _mm256_broadcast_ss(weights + j);
+                    const float* f = frames + j * stride + c;
+                    #if defined(__FMA__)
+                    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(f), w, acc0);
+                    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(f + 8), w, acc1);
+                    #else
+                    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(f), w));
+                    acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(f + 8), w));
+                    #endif
+                }
+                _mm256_storeu_ps(result + c, acc0);
+                _mm256_storeu_ps(result + c + 8, acc1);
+            }
+            for(; c + 8 <= stride; c += 8)
+            {
+                __m256 acc = _mm256_setzero_ps();
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(frames + j * stride + c), _mm256_broadcast_ss(weights + j)));
+                }
+                _mm256_storeu_ps(result + c, acc);
+            }
+#elif defined(IADSP_VECTOROPS_SSE2)
+            for(; c + 8 <= stride; c += 8)
+            {
+                __m128 acc0 = _mm_setzero_ps();
+                __m128 acc1 = _mm_setzero_ps();
+                for(size_t j = 0; j < numFrames; ++j)
+                {
+                    const __m128 w = _mm_set1_ps(weights[j]);
+                    const float* f = frames + j * stride + c;
+                    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(f), w));
+                    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(f + 4), w));
+                }
+                _mm_storeu_ps(result + c, acc0);
+                _mm_storeu_ps(result + c + 4, acc1);
+            }
+            for(; c + 4 <= stride; c += 4)
+            {
+                __m128 acc = _mm_setzero_ps();
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(frames + j * stride + c), _mm_set1_ps(weights[j])));
+                }
+                _mm_storeu_ps(result + c, acc);
+            }
+#elif defined(IADSP_VECTOROPS_NEON)
+            for(; c + 8 <= stride; c += 8)
+            {
+                float32x4_t acc0 = vdupq_n_f32(0.0f);
+                float32x4_t acc1 = vdupq_n_f32(0.0f);
+                for(size_t j = 0; j < numFrames; ++j)
+                {
+                    const float* f = frames + j * stride + c;
+                    acc0 = vmlaq_n_f32(acc0, vld1q_f32(f), weights[j]);
+                    acc1 = vmlaq_n_f32(acc1, vld1q_f32(f + 4), weights[j]);
+                }
+                vst1q_f32(result + c, acc0);
+                vst1q_f32(result + c + 4, acc1);
+            }
+            for(; c + 4 <= stride; c += 4)
+            {
+                float32x4_t acc = vdupq_n_f32(0.0f);
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc = vmlaq_n_f32(acc, vld1q_f32(frames + j * stride + c), weights[j]);
+                }
+                vst1q_f32(result + c, acc);
+            }
+#endif
+
+            for(; c < stride; ++c)
+            {
+                float acc = 0.0f;
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc += weights[j] * frames[j * stride + c];
+                }
+                result[c] = acc;
+            }
+        }
+
+        // double-lane version of weightedFrameSum() above
+        inline void weightedFrameSum(double* result, const double* frames, const double* weights, size_t numFrames, size_t stride) noexcept
+        {
+            size_t c = 0;
+
+#if defined(IADSP_VECTOROPS_AVX2)
+            for(; c + 8 <= stride; c += 8)
+            {
+                __m256d acc0 = _mm256_setzero_pd();
+                __m256d acc1 = _mm256_setzero_pd();
+                for(size_t j = 0; j < numFrames; ++j)
+                {
+                    const __m256d w = _mm256_broadcast_sd(weights + j);
+                    const double* f = frames + j * stride + c;
+                    #if defined(__FMA__)
+                    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(f), w, acc0);
+                    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(f + 4), w, acc1);
+                    #else
+                    acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(f), w));
+                    acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(f + 4), w));
+                    #endif
+                }
+                _mm256_storeu_pd(result + c, acc0);
+                _mm256_storeu_pd(result + c + 4, acc1);
+            }
+            for(; c + 4 <= stride; c += 4)
+            {
+                __m256d acc = _mm256_setzero_pd();
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(frames + j * stride + c), _mm256_broadcast_sd(weights + j)));
+                }
+                _mm256_storeu_pd(result + c, acc);
+            }
+#elif defined(IADSP_VECTOROPS_SSE2)
+            for(; c + 4 <= stride; c += 4)
+            {
+                __m128d acc0 = _mm_setzero_pd();
+                __m128d acc1 = _mm_setzero_pd();
+                for(size_t j = 0; j < numFrames; ++j)
+                {
+                    const __m128d w = _mm_set1_pd(weights[j]);
+                    const double* f = frames + j * stride + c;
+                    acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(f), w));
+                    acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(f + 2), w));
+                }
+                _mm_storeu_pd(result + c, acc0);
+                _mm_storeu_pd(result + c + 2, acc1);
+            }
+            for(; c + 2 <= stride; c += 2)
+            {
+                __m128d acc = _mm_setzero_pd();
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(frames + j * stride + c), _mm_set1_pd(weights[j])));
+                }
+                _mm_storeu_pd(result + c, acc);
+            }
+#elif defined(IADSP_VECTOROPS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+            for(; c + 2 <= stride; c += 2)
+            {
+                float64x2_t acc = vdupq_n_f64(0.0);
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc = vfmaq_f64(acc, vld1q_f64(frames + j * stride + c), vdupq_n_f64(weights[j]));
+                }
+                vst1q_f64(result + c, acc);
+            }
+#endif
+
+            for(; c < stride; ++c)
+            {
+                double acc = 0.0;
+                for(size_t j = 0; j < numFrames; ++j) {
+                    acc += weights[j] * frames[j * stride + c];
+                }
+                result[c] = acc;
+            }
+        }
+
+        // Radix-2 butterflies on split-complex data (separate real and imaginary arrays), for i in [0, n):
+        //     t = (re1[i] + i im1[i]) * (wr[i] + i wi[i])
+        //     (re0[i], im0[i]) = a + t,  (re1[i], im1[i]) = a - t,  where a = (re0[i], im0[i])
+        // This is the inner loop of one FFT stage, with wr/wi that stage's run of twiddle factors.
+        inline void complexButterflies(float* re0, float* im0, float* re1, float* im1, const float* wr, const float* wi, size_t n) noexcept
+        {
+            size_t i = 0;
+
+#if defined(IADSP_VECTOROPS_AVX2)
+            for(; i + 8 <= n; i += 8)
+            {
+                const __m256 br = _mm256_loadu_ps(re1 + i), bi = _mm256_loadu_ps(im1 + i);
+                const __m256 cr = _mm256_loadu_ps(wr + i), ci = _mm256_loadu_ps(wi + i);
+                #if defined(__FMA__)
+                const __m256 tr = _mm256_fmsub_ps(br, cr, _mm256_mul_ps(bi, ci));
+                const __m256 ti = _mm256_fmadd_ps(br, ci, _mm256_mul_ps(bi, cr));
+                #else
+                const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(br, cr), _mm256_mul_ps(bi, ci));
+                const __m256 ti = _mm256_add_ps(_mm256_mul_ps(br, ci), _mm256_mul_ps(bi, cr));
+                #endif
+                const __m256 ar = _mm256_loadu_ps(re0 + i), ai = _mm256_loadu_ps(im0 + i);
+                _mm256_storeu_ps(re0 + i, _mm256_add_ps(ar, tr));
+                _mm256_storeu_ps(im0 + i, _mm256_add_ps(ai, ti));
+                _mm256_storeu_ps(re1 + i, _mm256_sub_ps(ar, tr));
+                _mm256_storeu_ps(im1 + i, _mm256_sub_ps(ai, ti));
+            }
+#elif defined(IADSP_VECTOROPS_SSE2)
+            for(; i + 4 <= n; i += 4)
+            {
+                const __m128 br = _mm_loadu_ps(re1 + i), bi = _mm_loadu_ps(im1 + i);
+                const __m128 cr = _mm_loadu_ps(wr + i), ci = _mm_loadu_ps(wi + i);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, cr), _mm_mul_ps(bi, ci));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(br, ci), _mm_mul_ps(bi, cr));
+                const __m128 ar = _mm_loadu_ps(re0 + i), ai = _mm_loadu_ps(im0 + i);
+                _mm_storeu_ps(re0 + i, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(im0 + i, _mm_add_ps(ai, ti));
+                _mm_storeu_ps(re1 + i, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(im1 + i, _mm_sub_ps(ai, ti));
+            }
+#elif defined(IADSP_VECTOROPS_NEON)
+            for(; i + 4 <= n; i += 4)
+            {
+                const float32x4_t br = vld1q_f32(re1 + i), bi = vld1q_f32(im1 + i);
+                const float32x4_t cr = vld1q_f32(wr + i), ci = vld1q_f32(wi + i);
+                const float32x4_t tr = vmlsq_f32(vmulq_f32(br, cr), bi, ci);
+                const float32x4_t ti = vmlaq_f32(vmulq_f32(br, ci), bi, cr);
+                const float32x4_t ar = vld1q_f32(re0 + i), ai = vld1q_f32(im0 + i);
+                vst1q_f32(re0 + i, vaddq_f32(ar, tr));
+                vst1q_f32(im0 + i, vaddq_f32(ai, ti));
+                vst1q_f32(re1 + i, vsubq_f32(ar, tr));
+                vst1q_f32(im1 + i, vsubq_f32(ai, ti));
+            }
+#endif
+
+            for(; i < n; ++i)
+            {
+                const auto tr = re1[i] * wr[i] - im1[i] * wi[i];
+                const auto ti = re1[i] * wi[i] + im1[i] * wr[i];
+                re1[i] = re0[i] - tr;
+                im1[i] = im0[i] - ti;
+                re0[i] += tr;
+                im0[i] += ti;
+            }
+        }
+
+        // double-lane version of complexButterflies() above
+        inline void complexButterflies(double* re0, double* im0, double* re1, double* im1, const double* wr, const double* wi, size_t n) noexcept
+        {
+            size_t i = 0;
+
+#if defined(IADSP_VECTOROPS_AVX2)
+            for(; i + 4 <= n; i += 4)
+            {
+                const __m256d br = _mm256_loadu_pd(re1 + i), bi = _mm256_loadu_pd(im1 + i);
+                const __m256d cr = _mm256_loadu_pd(wr + i), ci = _mm256_loadu_pd(wi + i);
+                #if defined(__FMA__)
+                const __m256d tr = _mm256_fmsub_pd(br, cr, _mm256_mul_pd(bi, ci));
+                const __m256d ti = _mm256_fmadd_pd(br, ci, _mm256_mul_pd(bi, cr));
+                #else
+                const __m256d tr = _mm256_sub_pd(_mm256_mul_pd(br, cr), _mm256_mul_pd(bi, ci));
+                const __m256d ti = _mm256_add_pd(_mm256_mul_pd(br, ci), _mm256_mul_pd(bi, cr));
+                #endif
+                const __m256d ar = _mm256_loadu_pd(re0 + i), ai = _mm256_loadu_pd(im0 + i);
+                _mm256_storeu_pd(re0 + i, _mm256_add_pd(ar, tr));
+                _mm256_storeu_pd(im0 + i, _mm256_add_pd(ai, ti));
+                _mm256_storeu_pd(re1 + i, _mm256_sub_pd(ar, tr));
+                _mm256_storeu_pd(im1 + i, _mm256_sub_pd(ai, ti));
+            }
+#elif defined(IADSP_VECTOROPS_SSE2)
+            for(; i + 2 <= n; i += 2)
+            {
+                const __m128d br = _mm_loadu_pd(re1 + i), bi = _mm_loadu_pd(im1 + i);
+                const __m128d cr = _mm_loadu_pd(wr + i), ci = _mm_loadu_pd(wi + i);
+                const __m128d tr = _mm_sub_pd(_mm_mul_pd(br, cr), _mm_mul_pd(bi, ci));
+                const __m128d ti = _mm_add_pd(_mm_mul_pd(br, ci), _mm_mul_pd(bi, cr));
+                const __m128d ar = _mm_loadu_pd(re0 + i), ai = _mm_loadu_pd(im0 + i);
+                _mm_storeu_pd(re0 + i, _mm_add_pd(ar, tr));
+                _mm_storeu_pd(im0 + i, _mm_add_pd(ai, ti));
+                _mm_storeu_pd(re1 + i, _mm_sub_pd(ar, tr));
+                _mm_storeu_pd(im1 + i, _mm_sub_pd(ai, ti));
+            }
+#elif defined(IADSP_VECTOROPS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+            for(; i + 2 <= n; i += 2)
+            {
+                const float64x2_t br = vld1q_f64(re1 + i), bi = vld1q_f64(im1 + i);
+                const float64x2_t cr = vld1q_f64(wr + i), ci = vld1q_f64(wi + i);
+                const float64x2_t tr = vfmsq_f64(vmulq_f64(br, cr), bi, ci);
+                const float64x2_t ti = vfmaq_f64(vmulq_f64(br, ci), bi, cr);
+                const float64x2_t ar = vld1q_f64(re0 + i), ai = vld1q_f64(im0 + i);
+                vst1q_f64(re0 + i, vaddq_f64(ar, tr));
+                vst1q_f64(im0 + i, vaddq_f64(ai, ti));
+                vst1q_f64(re1 + i, vsubq_f64(ar, tr));
+                vst1q_f64(im1 + i, vsubq_f64(ai, ti));
+            }
+#endif
+
+            for(; i < n; ++i)
+            {
+                const auto tr = re1[i] * wr[i] - im1[i] * wi[i];
+                const auto ti = re1[i] * wi[i] + im1[i] * wr[i];
+                re1[i] = re0[i] - tr;
+                im1[i] = im0[i] - ti;
+                re0[i] += tr;
+                im0[i] += ti;
+            }
+        }
+    }
+}
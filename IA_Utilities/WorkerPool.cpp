@@ -0,0 +1,136 @@
+#include "WorkerPool.hpp"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
+
+namespace
+{
+    inline void spinPause() noexcept
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    inline uint32_t generationOf(uint64_t state) noexcept
+    {
+        return static_cast<uint32_t>(state >> 32);
+    }
+
+    inline int numTasksOf(uint64_t state) noexcept
+    {
+        return static_cast<int>((state >> 16) & 0xffffu);
+    }
+
+    inline int nextTaskOf(uint64_t state) noexcept
+    {
+        return static_cast<int>(state & 0xffffu);
+    }
+}
+
+WorkerPool::WorkerPool(int numThreads)
+{
+    if(numThreads < 0) {
+        numThreads = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    threads.reserve(numThreads);
+    for(int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([this] { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    quit.store(true, std::memory_order_relaxed);
+
+    // a new generation with no tasks wakes everyone up to see the quit flag
+    state.fetch_add(uint64_t { 1 } << 32, std::memory_order_release);
+    state.notify_all();
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(Task task, void* context, int numTasks) noexcept
+{
+    if(numTasks <= 0) {
+        return;
+    }
+    numTasks = std::min(numTasks, maxTasks);
+
+    if(threads.empty() || numTasks == 1)
+    {
+        for(int i = 0; i < numTasks; ++i) {
+            task(context, i);
+        }
+        return;
+    }
+
+    currentTask.store(task, std::memory_order_relaxed);
+    currentContext.store(context, std::memory_order_relaxed);
+    remaining.store(numTasks, std::memory_order_relaxed);
+
+    // publish: the release pairs with the acquire in runTasks(), making the fields above visible
+    const auto generation = generationOf(state.load(std::memory_order_relaxed)) + 1;
+    state.store((static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(numTasks) << 16), std::memory_order_release);
+    state.notify_all();
+
+    runTasks(generation);
+
+    while(remaining.load(std::memory_order_acquire) > 0) {
+        spinPause();
+    }
+}
+
+void WorkerPool::runTasks(uint32_t generation) noexcept
+{
+    auto current = state.load(std::memory_order_acquire);
+
+    while(generationOf(current) == generation)
+    {
+        const auto index = nextTaskOf(current);
+        if(index >= numTasksOf(current)) {
+            return;
+        }
+
+        if(state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            currentTask.load(std::memory_order_relaxed)(currentContext.load(std::memory_order_relaxed), index);
+            remaining.fetch_sub(1, std::memory_order_release);
+            current = state.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void WorkerPool::workerLoop() noexcept
+{
+    auto seenGeneration = generationOf(state.load(std::memory_order_acquire));
+
+    for(;;)
+    {
+        auto current = state.load(std::memory_order_acquire);
+        for(int spins = 0; generationOf(current) == seenGeneration; ++spins)
+        {
+            if(spins < spinIterations) {
+                spinPause();
+            }
+            else {
+                state.wait(current, std::memory_order_acquire);
+            }
+            current = state.load(std::memory_order_acquire);
+        }
+
+        seenGeneration = generationOf(current);
+        if(quit.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        runTasks(seenGeneration);
+    }
+}
@@ -0,0 +1,80 @@
+/*
+A small fork-join thread pool for splitting one audio-thread job (e.g. a channel loop) across cores
+without locks or allocation per job. The worker threads are spawned once, in the constructor, and live
+until the pool is destroyed.
+
+run(task, context, numTasks) calls task(context, i) once for every i in [0, numTasks), spread across the
+workers and the calling thread itself, and returns once all of them have finished. Tasks are claimed one
+at a time, so uneven ones balance out; the usual pattern is one task per contiguous range of channels.
+The task is a plain function pointer plus a void* context (a captureless lambda converts to one), so
+nothing is type-erased into a heap-allocated std::function. run(function, numTasks) is a shorthand that
+takes any callable f(int taskIndex) - typically a capturing lambda on the caller's stack - and passes it
+through that same pointer pair.
+
+Handoff is spin-then-wait: an idle worker polls for new work for a short while (long enough to catch the
+next call when jobs come back to back, as they do within one audio block) and then falls back to
+blocking in std::atomic::wait, so a pool that has nothing to do doesn't burn a core. The calling thread
+never blocks - once it runs out of tasks to claim it spins until the last one is done, which is
+normally a matter of microseconds. Waking a blocked worker costs a futex/WaitOnAddress call, so the
+first job after a long idle period is slower than the ones after it.
+
+Only one thread may call run() at a time (it is meant to be called from the audio thread), with at most
+maxTasks tasks per call. Tasks must not call back into the same pool. Thread priorities are left as the
+OS assigns them - raising them is platform-specific and best done by the host application.
+
+WorkerPool is neither copyable nor movable (it owns running threads).
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+    using Task = void (*)(void* context, int taskIndex);
+
+    // numThreads worker threads in addition to the caller; -1 picks one fewer than the number of cores
+    explicit WorkerPool(int numThreads = -1);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static constexpr int maxTasks = 0xffff;
+
+    int getNumThreads() const noexcept { return static_cast<int>(threads.size()); }
+
+    void run(Task task, void* context, int numTasks) noexcept;
+
+    template<typename Function>
+    void run(Function& function, int numTasks) noexcept
+    {
+        run([](void* context, int taskIndex) { (*static_cast<Function*>(context))(taskIndex); }, &function, numTasks);
+    }
+
+private:
+    void workerLoop() noexcept;
+
+    // claims and runs tasks of the given generation until there are none left
+    void runTasks(uint32_t generation) noexcept;
+
+    static constexpr int spinIterations = 20000;
+
+    // generation in the upper 32 bits, then the job's number of tasks and the index of its next
+    // unclaimed task in 16 bits each. A claim is one compare-exchange on all three, checked against the
+    // task count from the same snapshot, so a worker that is late for a job can never claim a task of
+    // the job after it.
+    std::atomic<uint64_t> state { 0 };
+    std::atomic<int> remaining { 0 };
+
+    // written before state is published, so read after it by whoever claims a task
+    std::atomic<Task> currentTask { nullptr };
+    std::atomic<void*> currentContext { nullptr };
+
+    std::atomic<bool> quit { false };
+    std::vector<std::thread> threads;
+};
@@ -0,0 +1,230 @@
+/*
+Single-producer/single-consumer throughput of Fifo with each of its position classes, against the
+layout FifoPositions had before its positions were padded onto separate cache lines and each side kept a
+cached copy of the other's (UnpaddedFifoPositions below, kept here only as the baseline).
+
+    cmake -S . -B build -DIADSP_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release
+    cmake --build build --target IADSP_FifoBenchmark
+    build/benchmarks/IADSP_FifoBenchmark [numItems] [numRuns]
+
+A producer thread streams numItems floats (default 200M) through the Fifo in blocks, with
+acquireWrite()/commitWrite(), while the main thread drains it with acquireRead()/commitRead() and checks
+every value arrived in order. Each side moves as much of a block as fits and yields when nothing does.
+For every block/ring size pair it prints the median throughput of numRuns runs (default 5).
+
+The difference the padding and caching make is in cache-line traffic between cores, so run this on a
+machine with at least two cores and leave it otherwise idle; with both threads on one core the numbers
+mostly measure the scheduler.
+*/
+
+#include "IA_Utilities/FiFo.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // FifoPositions as it was before the cache-line padding and cached positions: every prepareWrite()
+    // and prepareRead() loads the other side's position, and both positions share one cache line.
+    class UnpaddedFifoPositions
+    {
+    public:
+        using Region = FifoPositions::Region;
+
+        void setSize(int numElements) noexcept
+        {
+            totalSize = numElements;
+            reset();
+        }
+
+        void reset() noexcept
+        {
+            writePos.store(0);
+            readPos.store(0);
+        }
+
+        int size() const noexcept
+        {
+            return totalSize;
+        }
+
+        int getSizeToRead() const noexcept
+        {
+            return numReady(readPos.load(std::memory_order_acquire), writePos.load(std::memory_order_acquire));
+        }
+
+        int getFreeSpace() const noexcept
+        {
+            return totalSize - getSizeToRead() - 1;
+        }
+
+        Region prepareWrite(int numToWrite) noexcept
+        {
+            const auto ownWritePos = writePos.load(std::memory_order_relaxed);
+            const auto otherReadPos = readPos.load(std::memory_order_acquire);
+            numToWrite = std::min(numToWrite, totalSize - numReady(otherReadPos, ownWritePos) - 1);
+            return makeRegion(ownWritePos, otherReadPos, numToWrite);
+        }
+
+        Region prepareRead(int numToRead) noexcept
+        {
+            const auto ownReadPos = readPos.load(std::memory_order_relaxed);
+            const auto otherWritePos = writePos.load(std::memory_order_acquire);
+            numToRead = std::min(numToRead, numReady(ownReadPos, otherWritePos));
+            return makeRegion(ownReadPos, otherWritePos, numToRead);
+        }
+
+        void finishWrite(int numWritten) noexcept
+        {
+            writePos.store(advance(writePos.load(std::memory_order_relaxed), numWritten), std::memory_order_release);
+        }
+
+        void finishRead(int numRead) noexcept
+        {
+            readPos.store(advance(readPos.load(std::memory_order_relaxed), numRead), std::memory_order_release);
+        }
+
+    private:
+        int numReady(int from, int to) const noexcept
+        {
+            return to >= from ? (to - from) : (totalSize - from + to);
+        }
+
+        int advance(int position, int numItems) const noexcept
+        {
+            position += numItems;
+            return position >= totalSize ? position - totalSize : position;
+        }
+
+        Region makeRegion(int start, int limit, int numItems) const noexcept
+        {
+            Region region;
+            if(numItems <= 0) {
+                return region;
+            }
+
+            region.startIndex1 = start;
+            region.blockSize1 = std::min(totalSize - start, numItems);
+            numItems -= region.blockSize1;
+            region.blockSize2 = numItems <= 0 ? 0 : std::min(numItems, limit);
+            return region;
+        }
+
+        std::atomic<int> writePos {0};
+        std::atomic<int> readPos {0};
+        int totalSize = 1;
+    };
+
+    // one run: returns items per second, or 0 if anything arrived out of order
+    template<typename Positions>
+    double runOnce(long long numItems, int blockSize, int ringSize)
+    {
+        Fifo<float, Positions> fifo(ringSize);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::thread producer([&]
+        {
+            long long sent = 0;
+            while(sent < numItems)
+            {
+                const auto regions = fifo.acquireWrite(static_cast<int>(std::min<long long>(blockSize, numItems - sent)));
+                if(regions.size() == 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                auto value = sent;
+                for(auto& sample : regions.first) {
+                    sample = static_cast<float>(value++ & 0xffffff);
+                }
+                for(auto& sample : regions.second) {
+                    sample = static_cast<float>(value++ & 0xffffff);
+                }
+
+                fifo.commitWrite(static_cast<int>(regions.size()));
+                sent += static_cast<long long>(regions.size());
+            }
+        });
+
+        long long received = 0;
+        bool inOrder = true;
+        while(received < numItems)
+        {
+            const auto regions = fifo.acquireRead(blockSize);
+            if(regions.size() == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto value = received;
+            for(const auto sample : regions.first) {
+                inOrder &= sample == static_cast<float>(value++ & 0xffffff);
+            }
+            for(const auto sample : regions.second) {
+                inOrder &= sample == static_cast<float>(value++ & 0xffffff);
+            }
+
+            fifo.commitRead(static_cast<int>(regions.size()));
+            received += static_cast<long long>(regions.size());
+        }
+
+        producer.join();
+
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return inOrder ? static_cast<double>(numItems) / seconds : 0.0;
+    }
+
+    template<typename Positions>
+    double medianThroughput(long long numItems, int numRuns, int blockSize, int ringSize)
+    {
+        std::vector<double> results;
+        for(int run = 0; run < numRuns; ++run) {
+            results.push_back(runOnce<Positions>(numItems, blockSize, ringSize));
+        }
+
+        if(std::find(results.begin(), results.end(), 0.0) != results.end()) {
+            return 0.0;
+        }
+
+        std::sort(results.begin(), results.end());
+        return results[results.size() / 2];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const auto numItems = argc > 1 ? std::atoll(argv[1]) : 200'000'000LL;
+    const auto numRuns = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    const auto numCores = std::thread::hardware_concurrency();
+    std::printf("%lld items, median of %d runs, %u hardware threads\n", numItems, numRuns, numCores);
+    if(numCores < 2) {
+        std::printf("warning: producer and consumer will share one core, so this mostly measures scheduling\n");
+    }
+
+    struct Case { int blockSize, ringSize; };
+    const Case cases[] = { { 16, 1024 }, { 64, 4096 }, { 256, 4096 }, { 256, 65536 } };
+
+    std::printf("\n  block   ring   M items/s: unpadded   FifoPositions   PowerOfTwoFifoPositions\n");
+    for(const auto& c : cases)
+    {
+        const auto unpadded = medianThroughput<UnpaddedFifoPositions>(numItems, numRuns, c.blockSize, c.ringSize);
+        const auto padded = medianThroughput<FifoPositions>(numItems, numRuns, c.blockSize, c.ringSize);
+        const auto powerOfTwo = medianThroughput<PowerOfTwoFifoPositions>(numItems, numRuns, c.blockSize, c.ringSize);
+
+        std::printf("  %5d  %5d   %19.0f   %13.0f   %23.0f\n", c.blockSize, c.ringSize, unpadded / 1e6, padded / 1e6, powerOfTwo / 1e6);
+        if(unpadded == 0.0 || padded == 0.0 || powerOfTwo == 0.0)
+        {
+            std::printf("error: items arrived out of order\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}